@@ -11,6 +11,7 @@
 
 #include <InputADC.h>
 #include <AudioMonitor.h>
+#include <MinMaxPyramid.h>
 #include <Display.h>
   
 
@@ -23,8 +24,8 @@ int8_t channels0 [] =  {A2, -1, A2, A3, A4, A5, A6, A7, A8, A9};      // input p
 int8_t channels1 [] =  {-1, A16, A17, A18, A19, A20, A13, A12, A11};  // input pins for ADC1, terminate with -1
 
 uint updateScreen = 500;             // milliseconds
-float displayTime = 0.01;
-//float displayTime = 0.001*updateScreen;
+//float displayTime = 0.01;
+float displayTime = 0.001*updateScreen;
 
 // Pin assignment: ----------------------------------------------------
 
@@ -46,6 +47,7 @@ float displayTime = 0.01;
 
 DATA_BUFFER(AIBuffer, NAIBuffer, 256*256);
 InputADC aidata(AIBuffer, NAIBuffer);
+MinMaxPyramid pyramid(aidata);
 
 Display screen;
 elapsedMillis screenTime;
@@ -86,21 +88,33 @@ void setupScreen() {
   if (nplots > 8)
     nplots = 8;
   screen.setPlotAreas(nplots, 0.0, 0.0, 1.0, 1.0);
+  screen.clearPlots();
   screenTime = 0;
   screen.setBacklightOn();
 }
 
 
-void plotData() {   // 85ms
+void plotData() {
   if (screenTime > updateScreen) {
     screenTime -= updateScreen;
-    screen.clearPlots();   // 16ms
     size_t n = aidata.frames(displayTime);
-    float data[n];
-    size_t start = aidata.currentSample(n);
-    for (int k=0; k<aidata.nchannels(); k++) {
-      aidata.getData(k, start, data, n);
-      screen.plot(k%screen.numPlots(), data, n, k/screen.numPlots()); // 8ms for n=500
+    int npixels = screen.width();
+    if (n < 2*npixels) {
+      float data[n];
+      size_t start = aidata.currentSample(n);
+      for (int k=0; k<aidata.nchannels(); k++) {
+	aidata.getData(k, start, data, n);
+	screen.updatePlot(k%screen.numPlots(), data, n, k/screen.numPlots());
+      }
+    }
+    else {
+      // cost independent of displayTime:
+      int16_t mins[npixels];
+      int16_t maxs[npixels];
+      for (int k=0; k<aidata.nchannels(); k++) {
+	pyramid.getMinMax(k, n, mins, maxs, npixels);
+	screen.updatePlot(k%screen.numPlots(), mins, maxs, npixels, k/screen.numPlots());
+      }
     }
   }
 }
@@ -119,10 +133,12 @@ void setup() {
   screenTime = 0;
   aidata.start();
   aidata.report();
+  pyramid.start();
 }
 
 
 void loop() {
+  pyramid.update();
   plotData();
   audio.update();
 }
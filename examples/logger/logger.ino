@@ -11,6 +11,7 @@
 #elif defined(INPUT_TDM)
   #include <Wire.h>
   #include <ControlPCM186x.h>
+  #include <CodecGroup.h>
   #include <InputTDM.h>
   #include <InputTDMSettings.h>
 #endif
@@ -84,6 +85,7 @@ ControlPCM186x pcm1(I2C_BUS, PCM186x_I2C_ADDR1, TDM_BUS);
 #ifdef INPUT_TDM_2ND
 ControlPCM186x pcm2(I2C_BUS, PCM186x_I2C_ADDR2, TDM_BUS);
 #endif
+CodecGroup codecs;
 InputTDM aidata(AIBuffer, NAIBuffer);
 #endif
 
@@ -228,7 +230,6 @@ void storeData() {
 
 #if defined(INPUT_TDM)
 void setupPCM(InputTDM &tdm, ControlPCM186x &pcm, bool offs) {
-  pcm.begin();
   bool r = pcm.setMicBias(false, true);
   if (!r) {
     Serial.println("not available");
@@ -272,12 +273,22 @@ void setup() {
 #if defined(INPUT_TDM)
   aidata.setSwapLR();
   I2C_BUS.begin();
+  if (pcm1.begin())
+    codecs.add(pcm1);
+#ifdef INPUT_TDM_2ND
+  if (pcm2.begin())
+    codecs.add(pcm2);
+#endif
+  // configure all PCM chips in one pass:
+  codecs.beginBatch();
   Serial.print("Setup PCM 1: ");
   setupPCM(aidata, pcm1, false);
 #ifdef INPUT_TDM_2ND
   Serial.print("Setup PCM 2: ");
   setupPCM(aidata, pcm2, true);
 #endif
+  if (!codecs.flush() || !codecs.verify())
+    Serial.println("WARNING: failed to configure PCM chips");
   aidata.begin();
   Serial.println();
 #endif
@@ -63,6 +63,8 @@ void loop() {
   Serial.println("5) SD card erase and format");
   Serial.println("6) SD card list files");
   Serial.println("7) SD card remove files");
+  Serial.println("8) SD card buffer size benchmark");
+  Serial.println("9) SD card recorder benchmark (8 channels, 48kHz)");
   Serial.println();
   Serial.print("Please select an action: ");
   // clear serial input:
@@ -78,7 +80,7 @@ void loop() {
   Serial.readBytesUntil('\n', pval, 32);
   Serial.println(pval);
   Serial.println();
-  if (strlen(pval) != 1 || pval[0] < '1' || pval[0] > '7')
+  if (strlen(pval) != 1 || pval[0] < '1' || pval[0] > '9')
     return;
   // open SD card:
 #if defined(SDCARD_BUILTIN)
@@ -125,6 +127,12 @@ void loop() {
     }
     Serial.println();
   }
+  else if (pval[0] == '8') {
+    sdcard.benchmarkSweep();
+  }
+  else if (pval[0] == '9') {
+    sdcard.benchmarkRecorder(48000, 8);
+  }
   pause();
   // close SD card:
   sdcard.end();
@@ -0,0 +1,131 @@
+// Use Teensy 3.5/3.6/4.x
+
+// select a library for the TFT display:
+//#define ST7735_T3
+#define ST7789_T3
+//#define ILI9341_T3  // XXX does not compile yet
+//#define ILI9488_T3
+//#define ST7735_ADAFRUIT
+//#define ST7789_ADAFRUIT
+//#define ILI9341_ADAFRUIT
+
+// define pins to control TFT display:
+#define TFT_SCK   13
+#define TFT_MISO  12
+#define TFT_MOSI  11
+#define TFT_CS    10  
+#define TFT_RST    8 // 9
+#define TFT_DC     7 // 8 
+#define TFT_BL    30 // backlight PWM, -1 to not use it
+
+#include <InputADC.h>
+#include <AnalysisChain.h>
+#include <SpectrumAnalyzer.h>
+#include <Display.h>
+#include <AllDisplays.h>       // edit this file for your TFT monitor
+#include <TestSignals.h>
+
+
+// Settings: ------------------------------------------------------------------
+
+int bits = 12;                       // resolution: 10bit 12bit, or 16bit
+int averaging = 4;                   // number of averages per sample: , 4, 8, 16, 32
+uint32_t samplingRate = 44100;       // samples per second and channel in Hertz
+int8_t channels0 [] =  {A2, A3, -1, A4, A5, A6, A7, A8, A9};      // input pins for ADC0
+int8_t channels1 [] =  {-1, A16, A17, A18, A19, A20, A22, A10, A11};  // input pins for ADC1
+
+size_t nfft = 256;                   // frames per FFT segment
+float spectrumInterval = 0.02;       // seconds between spectrogram columns
+uint32_t analysisBudget = 2000;      // microseconds per loop() for the FFTs
+float powerMin = -100.0;             // decibel of lowest color
+float powerMax = -20.0;              // decibel of highest color
+
+int stimulusFrequency = 500;         // Hertz
+int signalPins[] = {5, 4, 3, 2, -1}; // pins where to put out test signals
+
+
+// ----------------------------------------------------------------------------
+
+DATA_BUFFER(AIBuffer, NAIBuffer, 256*256)
+
+InputADC aidata(AIBuffer, NAIBuffer);
+
+AnalysisChain analysis(aidata);
+SpectrumAnalyzer spectrum(&analysis, nfft);
+uint32_t spectrumCounter = 0;
+int plotChannel = -1;
+
+Display screen;
+
+
+void setupADC() {
+  aidata.setChannels(0, channels0);
+  aidata.setChannels(1, channels1);
+  aidata.setRate(samplingRate);
+  aidata.setResolution(bits);
+  aidata.setAveraging(averaging);
+  aidata.setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED);
+  aidata.setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED);
+  aidata.setReference(ADC_REFERENCE::REF_3V3);
+  aidata.check();
+}
+
+
+void setupScreen() {
+  int nplots = aidata.nchannels();
+  if (nplots > 8)
+    nplots = 8;
+  screen.setPlotAreas(nplots, 0.0, 0.0, 1.0, 1.0);
+  screen.clearPlots();
+  for (int k=0; k<nplots; k++)
+    screen.setSpectrumRange(k, powerMin, powerMax);
+  screen.setBacklightOn();
+}
+
+
+void setupAnalysis() {
+  spectrum.setWindow(SpectrumAnalyzer::HANN);
+  spectrum.setAverages(1);
+  analysis.setBudget(analysisBudget);
+  analysis.start(spectrumInterval, 2.0*nfft/aidata.rate());
+}
+
+
+void plotSpectra() {
+  // draw a single spectrum per call to keep loop() short:
+  if (plotChannel < 0) {
+    if (spectrum.counter() == spectrumCounter)
+      return;
+    spectrumCounter = spectrum.counter();
+    plotChannel = 0;
+  }
+  if (plotChannel < screen.numPlots() && plotChannel < spectrum.channels()) {
+    const float *power = spectrum.spectrum(plotChannel);
+    if (power != 0)
+      screen.plotSpectrum(plotChannel, power, spectrum.frequencies());
+    plotChannel++;
+  }
+  else
+    plotChannel = -1;
+}
+
+
+// ----------------------------------------------------------------------------
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 2000) {};
+  setupTestSignals(signalPins, stimulusFrequency);
+  setupADC();
+  initScreen(screen);
+  setupScreen();
+  aidata.start();
+  aidata.report();
+  setupAnalysis();
+}
+
+
+void loop() {
+  analysis.update();
+  plotSpectra();
+}
@@ -10,8 +10,20 @@ AnalysisChain::AnalysisChain(const DataWorker &data)
     Window(0.1),
     Continuous(false),
     Counter(-1),
+    Budget(0),
+    Overload(false),
+    NHop(0),
+    NFilled(0),
+    Arena(0),
+    NArena(0),
+    ArenaUsed(0),
+    HeapArena(0),
+    Buffer(0),
     NChannels(0),
-    NFrames(0)
+    NFrames(0),
+    Copied(false),
+    FloatBuffer(0),
+    Converted(false)
 {
   Time = 0;
 }
@@ -19,6 +31,8 @@ AnalysisChain::AnalysisChain(const DataWorker &data)
 
 AnalysisChain::~AnalysisChain() {
   stop();
+  if (HeapArena != 0)
+    free(HeapArena);
 }
 
 
@@ -29,80 +43,292 @@ void AnalysisChain::add(Analyzer &analyzer) {
 }
 
 
-void AnalysisChain::start(float interval, float window) {
+void AnalysisChain::setArena(uint8_t *arena, size_t narena) {
+  stop();
+  if (HeapArena != 0)
+    free(HeapArena);
+  HeapArena = 0;
+  Arena = arena;
+  NArena = narena;
+}
+
+
+bool AnalysisChain::allocateArena(size_t nbytes) {
+  if (nbytes <= NArena)
+    return true;
+  if (Arena != 0 && HeapArena == 0) {
+    Serial.printf("ERROR: analysis arena too small: need %u bytes, have %u bytes.\n",
+		  nbytes, NArena);
+    return false;
+  }
+  if (HeapArena != 0)
+    free(HeapArena);
+  Arena = 0;
+  NArena = 0;
+  // allocate with some slack for aligning to 32 bytes:
+  HeapArena = (uint8_t *)malloc(nbytes + 31);
+  if (HeapArena == 0) {
+    Serial.printf("ERROR: not enough memory to allocate %u bytes for analysis buffers.\n",
+		  nbytes);
+    return false;
+  }
+  Arena = (uint8_t *)(((uintptr_t)HeapArena + 31) & ~(uintptr_t)31);
+  NArena = nbytes;
+  return true;
+}
+
+
+bool AnalysisChain::start(float interval, float window) {
   stop();
   Interval = 1000*interval;
   Window = window;
   Time = 0;
   Counter = -1;
-  Continuous = (fabs(interval - window) < 1e-8);
+  Continuous = (interval < window + 1e-8);
   NChannels = nchannels();
-  if (NChannels > MaxChannels)
-    NChannels = MaxChannels;
   NFrames = frames(Window);
-  for(uint8_t c=0; c<NChannels; ++c) {
-    Buffer[c] = (sample_t*)malloc(NFrames*sizeof(sample_t));
-    if (Buffer[c] == 0) {
-      Serial.println("Not enough memory to allocate analysis buffer!");
-      while (1) {};
+  if (NChannels*NFrames > Data->nbuffer()) {
+    Serial.printf("ERROR: analysis window of %.3fs does not fit into data buffer.\n",
+		  Window);
+    NChannels = 0;
+    NFrames = 0;
+    return false;
+  }
+  NHop = Continuous ? frames(interval) : NFrames;
+  if (NHop == 0 || NHop > NFrames)
+    NHop = NFrames;
+  NFilled = 0;
+  // buffers for all analyzers, they might get enabled later on:
+  bool copy = false;
+  bool convert = false;
+  for (int i=0; i<NAnalyzer; i++) {
+    if (!Analyzers[i]->readOnly()) {
+      if (Analyzers[i]->floatData())
+	convert = true;
+      else
+	copy = true;
     }
   }
+  Buffer = 0;
+  FloatBuffer = 0;
+  ArenaUsed = 0;
+  // channel pointers followed by channel buffers aligned to 32 bytes:
+  size_t nptrs = (NChannels*sizeof(sample_t *) + 31) & ~(size_t)31;
+  size_t nchannel = (NFrames*sizeof(sample_t) + 31) & ~(size_t)31;
+  size_t nfptrs = (NChannels*sizeof(float *) + 31) & ~(size_t)31;
+  size_t nfchannel = (NFrames*sizeof(float) + 31) & ~(size_t)31;
+  size_t nbytes = 0;
+  if (copy)
+    nbytes += nptrs + NChannels*nchannel;
+  if (convert)
+    nbytes += nfptrs + NChannels*nfchannel;
+  if (nbytes > 0) {
+    if (!allocateArena(nbytes)) {
+      NChannels = 0;
+      NFrames = 0;
+      return false;
+    }
+    ArenaUsed = nbytes;
+  }
+  uint8_t *arena = Arena;
+  if (copy) {
+    Buffer = (sample_t **)arena;
+    for(uint8_t c=0; c<NChannels; ++c)
+      Buffer[c] = (sample_t *)(arena + nptrs + c*nchannel);
+    arena += nptrs + NChannels*nchannel;
+  }
+  if (convert) {
+    FloatBuffer = (float **)arena;
+    for(uint8_t c=0; c<NChannels; ++c)
+      FloatBuffer[c] = (float *)(arena + nfptrs + c*nfchannel);
+  }
+  Copied = false;
+  Converted = false;
   synchronize();
   for (int i=0; i<NAnalyzer; i++) {
-    if (Analyzers[i]->enabled()) {
-      Analyzers[i]->setContinuous(Continuous);
-      Analyzers[i]->setRate(rate());
-      Analyzers[i]->start(NChannels, NFrames);
-    }
+    Analyzers[i]->setContinuous(Continuous);
+    Analyzers[i]->setRate(rate());
+    Analyzers[i]->setDataResolution(dataResolution());
+    Analyzers[i]->setHop(NHop);
+    Analyzers[i]->resetDecimation();
+    Analyzers[i]->start(NChannels, NFrames);
   }
+  return true;
 }
 
 
 void AnalysisChain::stop() {
-  for (int i=0; i<NAnalyzer; i++) {
-    if (Analyzers[i]->enabled())
-      Analyzers[i]->stop();
-  }
-  for(uint8_t c=0; c<NChannels; ++c)
-    free(Buffer[c]);
+  for (int i=0; i<NAnalyzer; i++)
+    Analyzers[i]->stop();
+  Buffer = 0;
+  FloatBuffer = 0;
   NChannels = 0;
   NFrames = 0;
+  NHop = 0;
 }
 
 
-void AnalysisChain::update() {
-  if (NChannels == 0 || NFrames == 0)
+void AnalysisChain::copyData() {
+  if (Copied || Buffer == 0)
     return;
-  if (Counter >= 0 ) {
-    while ((Counter < NAnalyzer) && !Analyzers[Counter]->enabled())
-      Counter++;
-    if (Counter < NAnalyzer)
-      Analyzers[Counter++]->analyze(Buffer, NChannels, NFrames);
-    if (Counter >= NAnalyzer)
-      Counter = -1;
+  if (NHop < NFrames) {
+    for (uint8_t c=0; c<NChannels; c++) {
+      memmove(Buffer[c], Buffer[c] + NHop, (NFrames - NHop)*sizeof(sample_t));
+      HopView.getData(c, Buffer[c] + NFrames - NHop);
+    }
+  }
+  else {
+    for (uint8_t c=0; c<NChannels; c++)
+      View.getData(c, Buffer[c]);
+  }
+  Copied = true;
+}
+
+
+void AnalysisChain::convertData() {
+  if (Converted || FloatBuffer == 0)
+    return;
+  float scale = gain()*sampleScale(dataResolution());
+  if (NHop < NFrames) {
+    for (uint8_t c=0; c<NChannels; c++) {
+      memmove(FloatBuffer[c], FloatBuffer[c] + NHop,
+	      (NFrames - NHop)*sizeof(float));
+      HopView.getData(c, FloatBuffer[c] + NFrames - NHop, scale);
+    }
+  }
+  else {
+    for (uint8_t c=0; c<NChannels; c++)
+      View.getData(c, FloatBuffer[c], scale);
+  }
+  Converted = true;
+}
+
+
+void AnalysisChain::setBudget(uint32_t usecs) {
+  Budget = usecs;
+}
+
+
+void AnalysisChain::resetTiming() {
+  for (int i=0; i<NAnalyzer; i++)
+    Analyzers[i]->resetTiming();
+}
+
+
+void AnalysisChain::report(Stream &stream) const {
+  stream.println("Analyzer timing:");
+  for (int i=0; i<NAnalyzer; i++) {
+    const Analyzer *a = Analyzers[i];
+    stream.printf("  %2d: priority %u, decimation %2u, %7lu calls, %5lu skipped, mean %8.1fus, max %6luus, last %6luus%s\n",
+		  i + 1, a->priority(), a->decimation(), a->calls(), a->skipped(),
+		  a->meanTime(), a->maxTime(), a->lastTime(),
+		  a->enabled() ? "" : " (disabled)");
+  }
+  stream.println();
+}
+
+
+bool AnalysisChain::nextWindow() {
+  if (Continuous) {
+    if (available() < nchannels()*NHop)
+      return false;
   }
   else {
+    if (Time <= Interval)
+      return false;
+    Time -= Interval;
+  }
+  // view on data:
+  size_t start;
+  if (Continuous) {
+    HopView.set(Data->buffer(), Data->nbuffer(), nchannels(), index(),
+		NChannels, NHop);
+    // window ends with the new hop:
+    start = index() + Data->nbuffer() - nchannels()*(NFrames - NHop);
+    NFilled += NHop;
+    if (NFilled > NFrames)
+      NFilled = NFrames;
+  }
+  else {
+    start = currentSample(NFrames);
+    synchronize();
+    NFilled = NFrames;
+  }
+  View.set(Data->buffer(), Data->nbuffer(), nchannels(), start,
+	   NChannels, NFrames);
+  Copied = false;
+  Converted = false;
+  // skip low priority analyzers if we are lagging behind by more than a hop:
+  Overload = (Continuous && Budget > 0 &&
+	      available() >= 2*nchannels()*NHop);
+  Counter = 0;
+  return true;
+}
+
+
+void AnalysisChain::runAnalyzer(uint32_t start) {
+  while ((Counter < NAnalyzer) && !Analyzers[Counter]->enabled())
+    Counter++;
+  if (Counter < NAnalyzer) {
+    Analyzer *analyzer = Analyzers[Counter];
+    bool resumed = analyzer->pending();
+    if (Continuous && !resumed)
+      analyzer->update(HopView);
+    analyzer->clearPending();
+    if (NFilled >= NFrames) {
+      if (analyzer->priority() > 0 &&
+	  (Overload || (!resumed && analyzer->decimate())))
+	analyzer->addSkipped();
+      else {
+	uint32_t t0 = micros();
+	uint32_t budget = 0;
+	if (Budget > 0)
+	  budget = t0 - start < Budget ? Budget - (t0 - start) : 1;
+	analyzer->setBudget(budget);
+	if (analyzer->readOnly())
+	  analyzer->analyze(View);
+	else if (analyzer->floatData()) {
+	  convertData();
+	  analyzer->analyze(FloatBuffer, NChannels, NFrames);
+	}
+	else {
+	  copyData();
+	  analyzer->analyze(Buffer, NChannels, NFrames);
+	}
+	uint32_t t1 = micros();
+	analyzer->addTime(t1 - t0);
+	if (Budget > 0 && t1 - start > Budget)
+	  Overload = true;
+	if (Budget > 0 && analyzer->priority() > 0 && !analyzer->pending())
+	  analyzer->adaptDecimation(Overload);
+      }
+    }
+    if (!analyzer->pending())
+      Counter++;
+  }
+  if (Counter >= NAnalyzer) {
+    Counter = -1;
     if (Continuous) {
-      if (available() < NChannels*NFrames)
-	return;
+      // sliding buffers need every hop:
+      copyData();
+      convertData();
+      increment(nchannels() * NHop);
     }
-    else {
-      if (Time <= Interval)
+  }
+}
+
+
+void AnalysisChain::update() {
+  if (NChannels == 0 || NFrames == 0)
+    return;
+  uint32_t start = micros();
+  do {
+    if (Counter < 0) {
+      if (!nextWindow())
+	return;
+      if (Budget == 0)
 	return;
-      Time -= Interval;
     }
-    // get data:
-    size_t start;
-    if (Continuous)
-      start = index();
-    else
-      start = currentSample(NFrames);
-    for (uint8_t c=0; c<NChannels; c++)
-      Data->getData(c, start, Buffer[c], NFrames);
-    if (Continuous)
-      increment(NChannels * NFrames);
-    else
-      synchronize();
-    Counter = 0;
-  }
+    runAnalyzer(start);
+  } while (Budget > 0 && micros() - start < Budget);
 }
@@ -10,6 +10,21 @@
 #include <Arduino.h>
 #include <DataWorker.h>
 #include <DataBuffer.h>
+#include <DataView.h>
+
+
+// Macro for defining a static memory arena for the analysis buffers
+// in DMAMEM to be passed to AnalysisChain::setArena().
+// arena and narena are the variable names for the arena and its size
+// in bytes.
+#define ANALYSIS_ARENA(arena, narena, n) \
+  static const size_t narena = n;				   \
+  static DMAMEM uint8_t __attribute__((aligned(32))) arena[n];
+
+// Same as ANALYSIS_ARENA but allocates the arena in PSRAM (Teensy 4.1 only).
+#define EXT_ANALYSIS_ARENA(arena, narena, n) \
+  static const size_t narena = n;				   \
+  static EXTMEM uint8_t __attribute__((aligned(32))) arena[n];
 
 
 class Analyzer;
@@ -26,16 +41,72 @@ class AnalysisChain : DataWorker {
   // Add an analyzer to analysis chain.
   void add(Analyzer &analyzer);
 
-  // Initialize analysis. Needs to be called before update() is used.
+  // Use the narena bytes of arena for all analysis buffers,
+  // for example an arena defined by the ANALYSIS_ARENA or
+  // EXT_ANALYSIS_ARENA macros.
+  // Otherwise, the analysis buffers are allocated on the heap
+  // as a single block that is reused on subsequent calls of start().
+  void setArena(uint8_t *arena, size_t narena);
+
+  // Number of bytes needed for the analysis buffers of the current window.
+  size_t arenaSize() const { return ArenaUsed; };
+
+  // Initialize analysis of all channels. Needs to be called before
+  // update() is used.
   // Analysis functions will be called every interval seconds on a data window
   // of window seconds length.
-  void start(float interval, float window);
+  // If interval equals window, successive windows are continuous.
+  // If interval is smaller than window, the window slides continuously
+  // in hops of interval seconds over the data and overlaps with
+  // the previous window (e.g. interval = window/2 for 50% overlap).
+  // Otherwise the most recent window is analyzed every interval seconds.
+  // All added analyzers are started and get analysis buffers, also
+  // disabled ones, so that they can be enabled later on.
+  // Return false and report error if the window does not fit into the
+  // data buffer or if the analysis buffers could not be allocated.
+  bool start(float interval, float window);
+
+  // Number of frames the window is advanced for each analysis
+  // of continuous data.
+  size_t hop() const { return NHop; };
 
   // Clean up analysis. After this update() will not do anything.
   void stop();
 
+  // Time budget in microseconds for each call of update().
+  uint32_t budget() const { return Budget; };
+
+  // Set time budget in microseconds for each call of update().
+  // If zero (default), update() runs a single analyzer per call.
+  // Otherwise, update() runs analyzers until the budget is used up.
+  // If the budget is exceeded, or if continuous analysis lags behind
+  // the data by more than a hop, analyzers with a priority larger than
+  // zero are skipped for the rest of the current window.
+  // An analyzer with a priority larger than zero that exceeds the
+  // budget is run only on every Analyzer::decimation()-th window
+  // from then on. Decimation is relaxed again by one for each of its
+  // runs within the budget.
+  void setBudget(uint32_t usecs);
+
+  // Reset timing statistics of all analyzers.
+  void resetTiming();
+
+  // Report timing statistics of all analyzers on stream.
+  void report(Stream &stream=Serial) const;
+
   // Call the analysis functions at appropriate times.
   // Call this functions as often as possible in loop().
+  // Each call runs at most a single analyzer, or as many
+  // as fit into the budget().
+  // Analyzers that split their work via Analyzer::resume()
+  // continue on the next call.
+  // Read-only analyzers get a view directly into the data buffer.
+  // The data are copied only once per window, and only if there are
+  // analyzers that are not read-only. Likewise, the data are converted
+  // to float and scaled by the gain only once per window, and only if
+  // there are analyzers requesting float data.
+  // Make the data buffer large enough such that the data of the
+  // current window are not overwritten before all analyzers have been run.
   void update();
   
   
@@ -50,11 +121,44 @@ class AnalysisChain : DataWorker {
   elapsedMillis Time;
   bool Continuous;
   int Counter;
+  uint32_t Budget;
+  bool Overload;    // budget exceeded while analyzing current window.
+  size_t NHop;      // frames per hop for continuous windows.
+  size_t NFilled;   // frames filled into sliding window so far.
+
+  // Set up views on the next window if data are available.
+  // Return true if a new window is ready for analysis.
+  bool nextWindow();
+
+  // Run the next analyzer on the current window.
+  // start is the time in microseconds update() was called.
+  void runAnalyzer(uint32_t start);
+
+  // Copy data of the current window into Buffer if not done already.
+  // For sliding windows only the new hop is appended.
+  void copyData();
+
+  // Convert data of the current window into FloatBuffer if not done already.
+  // For sliding windows only the new hop is appended.
+  void convertData();
+
+  // Make sure the arena can hold nbytes bytes.
+  // Return false if not enough memory is available.
+  bool allocateArena(size_t nbytes);
+
+  uint8_t *Arena;   // aligned memory holding all analysis buffers.
+  size_t NArena;    // capacity of Arena in bytes.
+  size_t ArenaUsed; // bytes of Arena in use.
+  uint8_t *HeapArena; // unaligned heap memory containing Arena, if any.
 
-  static const int MaxChannels = 4;
-  sample_t *Buffer[MaxChannels];
+  sample_t **Buffer; // copies of the channels, carved from Arena.
   uint8_t NChannels;
   size_t NFrames;
+  bool Copied;      // data of current window have been copied to Buffer.
+  float **FloatBuffer; // float data of the channels, carved from Arena.
+  bool Converted;   // data of current window have been converted to FloatBuffer.
+  DataView View;
+  DataView HopView;
   
 };
 
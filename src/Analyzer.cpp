@@ -5,7 +5,21 @@
 Analyzer::Analyzer(AnalysisChain *chain) :
   Enabled(true),
   Continuous(false),
-  Rate(0) {
+  ReadOnly(false),
+  FloatData(false),
+  Rate(0),
+  Scale(sampleScale(16)),
+  Hop(0),
+  Priority(0),
+  Decimation(1),
+  DecimationCounter(0),
+  Budget(0),
+  Pending(false),
+  Calls(0),
+  Skipped(0),
+  LastTime(0),
+  MaxTime(0),
+  TotalTime(0) {
   if (chain != 0)
     chain->add(*this);
 }
@@ -41,6 +55,122 @@ void Analyzer::setRate(float rate) {
 }
 
 
+void Analyzer::setDataResolution(uint8_t bits) {
+  Scale = sampleScale(bits);
+}
+
+
+size_t Analyzer::hop() const {
+  return Hop;
+}
+
+
+void Analyzer::setHop(size_t nhop) {
+  Hop = nhop;
+}
+
+
+bool Analyzer::readOnly() const {
+  return ReadOnly;
+}
+
+
+bool Analyzer::floatData() const {
+  return FloatData;
+}
+
+
+uint8_t Analyzer::priority() const {
+  return Priority;
+}
+
+
+void Analyzer::setPriority(uint8_t priority) {
+  Priority = priority;
+}
+
+
+void Analyzer::adaptDecimation(bool overload) {
+  if (overload) {
+    Decimation = 2*Decimation < MaxDecimation ? 2*Decimation : MaxDecimation;
+    DecimationCounter = 0;
+  }
+  else if (Decimation > 1)
+    Decimation--;
+}
+
+
+bool Analyzer::decimate() {
+  DecimationCounter++;
+  if (DecimationCounter >= Decimation) {
+    DecimationCounter = 0;
+    return false;
+  }
+  return true;
+}
+
+
+void Analyzer::resetDecimation() {
+  Decimation = 1;
+  DecimationCounter = 0;
+}
+
+
+uint32_t Analyzer::budget() const {
+  return Budget;
+}
+
+
+void Analyzer::setBudget(uint32_t usecs) {
+  Budget = usecs;
+}
+
+
+bool Analyzer::pending() const {
+  return Pending;
+}
+
+
+void Analyzer::clearPending() {
+  Pending = false;
+}
+
+
+void Analyzer::resume() {
+  Pending = true;
+}
+
+
+void Analyzer::addTime(uint32_t usecs) {
+  Calls++;
+  LastTime = usecs;
+  if (usecs > MaxTime)
+    MaxTime = usecs;
+  TotalTime += usecs;
+}
+
+
+void Analyzer::addSkipped() {
+  Skipped++;
+}
+
+
+float Analyzer::meanTime() const {
+  if (Calls == 0)
+    return 0.0;
+  return float(TotalTime)/Calls;
+}
+
+
+void Analyzer::resetTiming() {
+  Calls = 0;
+  Skipped = 0;
+  LastTime = 0;
+  MaxTime = 0;
+  TotalTime = 0;
+}
+
+
 void Analyzer::start(uint8_t nchannels, size_t nframes) {
 }
 
@@ -49,3 +179,19 @@ void Analyzer::stop() {
 }
 
 
+void Analyzer::update(const DataView &data) {
+}
+
+
+void Analyzer::analyze(sample_t **data, uint8_t nchannels, size_t nframes) {
+}
+
+
+void Analyzer::analyze(const float *const *data, uint8_t nchannels,
+		       size_t nframes) {
+}
+
+
+void Analyzer::analyze(const DataView &data) {
+}
+
@@ -9,6 +9,7 @@
 
 #include <Arduino.h>
 #include <DataBuffer.h>
+#include <DataView.h>
 
 
 class AnalysisChain;
@@ -40,23 +41,160 @@ class Analyzer {
   // Set sampling rate of data. This is done by AnalysisChain::start().
   void setRate(float rate);
 
+  // Set resolution of data in bits per sample.
+  // This is done by AnalysisChain::start().
+  void setDataResolution(uint8_t bits);
+
+  // Number of new frames by which the window is advanced for
+  // continuous data.
+  size_t hop() const;
+
+  // Set number of frames of each hop. This is done by AnalysisChain::start().
+  void setHop(size_t nhop);
+
+  // True if this analyzer only reads the data.
+  // Then AnalysisChain calls analyze(const DataView&) with a view
+  // directly into the data buffer, otherwise one of the other
+  // analyze() functions with a copy of the data.
+  bool readOnly() const;
+
+  // True if this analyzer works on data converted to float.
+  // Then AnalysisChain calls analyze(const float *const*, ...) with
+  // data multiplied by the gain, i.e. in the unit of the data.
+  bool floatData() const;
+
+  // Priority of this analyzer. Analyzers with priority 0 (default)
+  // are always run. Analyzers with larger priorities are skipped
+  // by AnalysisChain if the time budget has been exceeded.
+  uint8_t priority() const;
+
+  // Set priority of this analyzer.
+  void setPriority(uint8_t priority);
+
+  // Maximum decimation of analyzers exceeding the time budget.
+  static const uint8_t MaxDecimation = 16;
+
+  // Analyzers with priority larger than zero are only run on every
+  // decimation()-th window after they exceeded the time budget.
+  uint8_t decimation() const { return Decimation; };
+
+  // Double decimation up to MaxDecimation if overload,
+  // otherwise reduce it by one.
+  // This is done by AnalysisChain::update() after each analysis.
+  void adaptDecimation(bool overload);
+
+  // True if the current window is to be skipped because of decimation.
+  // This is done by AnalysisChain::update() once per window.
+  bool decimate();
+
+  // Run on every window again. This is done by AnalysisChain::start().
+  void resetDecimation();
+
+  // Time in microseconds available for the current call of analyze().
+  // Zero if there is no time limit.
+  uint32_t budget() const;
+
+  // Set time budget in microseconds for the next call of analyze().
+  // This is done by AnalysisChain::update().
+  void setBudget(uint32_t usecs);
+
+  // True if analyze() requested to be called again on the same data.
+  bool pending() const;
+
+  // Clear pending request. This is done by AnalysisChain::update().
+  void clearPending();
+
+  // Add usecs microseconds needed by a call of analyze() to the
+  // timing statistics. This is done by AnalysisChain::update().
+  void addTime(uint32_t usecs);
+
+  // Count a skipped call of analyze(). This is done by AnalysisChain::update().
+  void addSkipped();
+
+  // Number of calls of analyze().
+  uint32_t calls() const { return Calls; };
+
+  // Number of analysis windows skipped because of exceeded time budget
+  // or decimation.
+  uint32_t skipped() const { return Skipped; };
+
+  // Duration of the last call of analyze() in microseconds.
+  uint32_t lastTime() const { return LastTime; };
+
+  // Maximum duration of calls of analyze() in microseconds.
+  uint32_t maxTime() const { return MaxTime; };
+
+  // Average duration of calls of analyze() in microseconds.
+  float meanTime() const;
+
+  // Reset timing statistics.
+  void resetTiming();
+
   // Start and initialize analyzer. Default implementation does nothing.
   virtual void start(uint8_t nchannels, size_t nframes);
 
   // Stop analyzer. Default implementation does nothing.
   virtual void stop();
 
+  // Update running statistics with the hop() new frames in data.
+  // Called for continuous data for each hop before analyze(),
+  // also while the first window is not filled yet.
+  // Default implementation does nothing.
+  virtual void update(const DataView &data);
+
   // Analyze data of nchannels channels each holding nframes frames of data.
-  // The sampling rate of the data are stored in the member variable Rate.
+  // The sampling rate of the data are stored in the member variable Rate,
+  // the factor normalizing the samples to -1 to 1 in Scale.
   // Note that this function is allowed to modify the data in place.
-  virtual void analyze(sample_t **data, uint8_t nchannels, size_t nframes) = 0;
+  // Work taking longer than budget() should be split into chunks:
+  // call resume() and continue with the next chunk on the next call.
+  // Called for analyzers that are neither readOnly() nor floatData().
+  // Default implementation does nothing.
+  virtual void analyze(sample_t **data, uint8_t nchannels, size_t nframes);
+
+  // Analyze data of nchannels channels each holding nframes frames
+  // of data converted to float and multiplied by the gain of the data.
+  // The data are shared by all analyzers working on float data and
+  // cannot be modified.
+  // Like the other analyze() functions it can be split into chunks
+  // via resume().
+  // Called for analyzers with floatData() that are not readOnly().
+  // Default implementation does nothing.
+  virtual void analyze(const float *const *data, uint8_t nchannels,
+		       size_t nframes);
+
+  // Analyze data directly in the data buffer without modifying them.
+  // Like the other analyze() function it can be split into chunks
+  // via resume().
+  // Called for analyzers that are readOnly().
+  // Default implementation does nothing.
+  virtual void analyze(const DataView &data);
   
   
  protected:
 
+  // Call this from analyze() to be called again on the same data
+  // for analyzing the next chunk of work.
+  void resume();
+
   bool Enabled;
   bool Continuous;
+  bool ReadOnly;     // set to true in constructor of read-only analyzers
+  bool FloatData;    // set to true in constructor of float analyzers
   float Rate;
+  float Scale;       // factor normalizing samples to the range -1 to 1
+  size_t Hop;
+  uint8_t Priority;
+  uint8_t Decimation;
+  uint8_t DecimationCounter;
+  uint32_t Budget;
+  bool Pending;
+
+  uint32_t Calls;
+  uint32_t Skipped;
+  uint32_t LastTime;
+  uint32_t MaxTime;
+  uint64_t TotalTime;
   
 };
 
@@ -22,7 +22,13 @@ AudioMonitor::AudioMonitor(DataWorker &data, AudioStream &speaker) :
 
 
 void AudioMonitor::setMixer(AudioPlayBuffer::MixerFunc mixer) {
-  Data.mixer = mixer;
+  (Data.*mixer)();
+}
+
+
+void AudioMonitor::setMixer(const float *left, const float *right,
+			    uint8_t nchannels) {
+  Data.setMixer(left, right, nchannels);
 }
 
 
@@ -59,6 +65,26 @@ void AudioMonitor::setLowpass(int16_t n) {
 }
 
 
+void AudioMonitor::setDirect() {
+  Data.setDirect();
+}
+
+
+void AudioMonitor::setHeterodyne(float freq) {
+  Data.setHeterodyne(freq);
+}
+
+
+void AudioMonitor::setDivision(uint8_t factor, float threshold) {
+  Data.setDivision(factor, threshold);
+}
+
+
+void AudioMonitor::setExpansion(uint8_t factor) {
+  Data.setExpansion(factor);
+}
+
+
 void AudioMonitor::pause() {
   Play = false;
   Data.setMute(true);
@@ -158,6 +184,7 @@ void AudioMonitor::setVolume() {
 void AudioMonitor::update() {
   if (!Play)
     return;
+  Data.setupResampler();
   if (VolumeButtons) {
     VolumeUpButton.update();
     VolumeDownButton.update();
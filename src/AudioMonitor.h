@@ -25,9 +25,15 @@ class AudioMonitor {
   AudioMonitor(DataWorker &data, AudioStream &speaker);
 
   // Set the mixer function that maps the data buffer to the audio
-  // stream. See AudioPlayBuffer for details.
+  // stream, e.g. &AudioPlayBuffer::difference.
+  // See AudioPlayBuffer for details.
   void setMixer(AudioPlayBuffer::MixerFunc mixer);
 
+  // Mix the first nchannels channels of the data buffer with weights
+  // left into the left and with weights right into the right audio
+  // channel. See AudioPlayBuffer::setMixer() for details.
+  void setMixer(const float *left, const float *right, uint8_t nchannels);
+
   // Setup an amplifier for the audio monitor.
   // If `amplifier_pin` is positive, it is configured for output and
   // set to high to switch on/enable an amplifier chip.
@@ -43,9 +49,27 @@ class AudioMonitor {
 		   int volume_down_pin=-1, int mode=INPUT_PULLUP);
   
   // Set low-pass filter time-constant for audio output to n/44.1kHz,
-  // default is 10. Must be larger or equal to one.
+  // default is 1 (no filtering). Must be larger or equal to one.
   void setLowpass(int16_t n);
 
+  // Current mode for monitoring ultrasound.
+  AudioPlayBuffer::MODE mode() const { return Data.mode(); };
+
+  // Play data directly (default).
+  void setDirect();
+
+  // Play data multiplied by a sine wave of freq Hertz.
+  // See AudioPlayBuffer::setHeterodyne() for details.
+  void setHeterodyne(float freq);
+
+  // Play data with frequencies divided by factor.
+  // See AudioPlayBuffer::setDivision() for details.
+  void setDivision(uint8_t factor, float threshold=0.005);
+
+  // Play snippets of data slowed down by factor.
+  // See AudioPlayBuffer::setExpansion() for details.
+  void setExpansion(uint8_t factor);
+
   // Pause playing data and feedbacks on speaker.
   void pause();
 
@@ -73,6 +97,8 @@ class AudioMonitor {
   void setFeedback(float frac, uint8_t soundidx=0);
 
   // Call as often as possible in loop().
+  // Sets up the resampler of the audio stream whenever the sampling
+  // rate of the data changes.
   // Checks volume buttons and calls volumeUp() and volumeDown() accordingly.
   // Initiates playing audio feedbacks.
   void update();
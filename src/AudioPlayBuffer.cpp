@@ -3,27 +3,46 @@
 #include "AudioPlayBuffer.h"
 
 
+int16_t AudioPlayBuffer::Sine[AudioPlayBuffer::NSine] = {0};
+
+
 AudioPlayBuffer::AudioPlayBuffer()
   : DataWorker(),
     AudioStream(0, NULL),
-    Time(0.0),
     Mute(false),
     LeftVal(0),
     RightVal(0),
-    LowpassN(10) {
-  mixer = &AudioPlayBuffer::average;
+    LowpassN(1),
+    MixMode(AVERAGE),
+    MixChannels(0),
+    Mode(DIRECT),
+    HeterodyneFreq(0),
+    Phase(0),
+    PhaseStep(0),
+    Factor(1),
+    Threshold(0),
+    MixPos(0),
+    MixN(0) {
 }
 
 
 AudioPlayBuffer::AudioPlayBuffer(const DataWorker &producer)
   : DataWorker(&producer),
     AudioStream(0, NULL),
-    Time(0.0),
     Mute(false),
     LeftVal(0),
     RightVal(0),
-    LowpassN(10) {
-  mixer = &AudioPlayBuffer::average;
+    LowpassN(1),
+    MixMode(AVERAGE),
+    MixChannels(0),
+    Mode(DIRECT),
+    HeterodyneFreq(0),
+    Phase(0),
+    PhaseStep(0),
+    Factor(1),
+    Threshold(0),
+    MixPos(0),
+    MixN(0) {
 }
 
 
@@ -31,19 +50,54 @@ AudioPlayBuffer::~AudioPlayBuffer() {
 }
 
 
+float AudioPlayBuffer::inputRate() const {
+  if (Mode == EXPANSION)
+    return float(rate())/Factor;
+  return rate();
+}
+
+
+bool AudioPlayBuffer::setupResampler() {
+  if (Producer == 0 || rate() == 0)
+    return false;
+  setupMixer();
+  if (HeterodyneFreq > 0)
+    PhaseStep = (uint32_t)(HeterodyneFreq/rate()*4294967296.0);
+  if (Resample.ready(inputRate(), AUDIO_SAMPLE_RATE_EXACT))
+    return true;
+  Resampler resampler;
+  if (!resampler.setup(inputRate(), AUDIO_SAMPLE_RATE_EXACT))
+    return false;
+  AudioNoInterrupts();
+  Resample.swap(resampler);
+  MixPos = 0;
+  MixN = 0;
+  AudioInterrupts();
+  return true;
+}
+
+
 void AudioPlayBuffer::update() {
   // this function should be as fast as possible!
 
   if (Producer == 0 || Mute)
     return;
+  uint8_t nchans = nchannels();
+  if (!Resample.ready(inputRate(), AUDIO_SAMPLE_RATE_EXACT) ||
+      MixChannels != nchans)
+    return;
+  if (Mode == EXPANSION && available() > nbuffer()/2) {
+    // skip data that arrived while playing the previous snippet:
+    synchronize();
+    MixPos = 0;
+    MixN = 0;
+  }
   
   audio_block_t *block1 = NULL;
   audio_block_t *block2 = NULL;
 
-  ssize_t navail = available();
-
-  double interval = 1.0/AUDIO_SAMPLE_RATE_EXACT;
-  if (time(navail) < AUDIO_BLOCK_SAMPLES*interval)
+  size_t navail = available()/nchans + MixN - MixPos;
+  if (navail < Resample.frames(AUDIO_BLOCK_SAMPLES))
     return;
   
   // allocate audio blocks to transmit:
@@ -56,29 +110,30 @@ void AudioPlayBuffer::update() {
       return;
   }
   
-  // copy data into audio block buffer:
-  uint8_t nchans = nchannels();
-  ssize_t start = Index;
+  // resample data into audio block buffer:
   int16_t left;
   int16_t right;
-  unsigned int i = 0;
-  while (i<AUDIO_BLOCK_SAMPLES) {
-    (this->*mixer)(left, right);
-    LeftVal += (left - LeftVal)/LowpassN;
-    block1->data[i] = LeftVal;
-    if (numConnections > 1) {
+  for (unsigned int i=0; i<AUDIO_BLOCK_SAMPLES; i++) {
+    Resample.output(left, right);
+    if (LowpassN > 1) {
+      LeftVal += (left - LeftVal)/LowpassN;
       RightVal += (right - RightVal)/LowpassN;
-      block2->data[i] = RightVal;
     }
-    i++;
-    Time += interval;
-    while (navail > 0 && Time > time(Index - start + nchans)) {
-      navail -= nchans;
-      if (increment(nchans))
-	start -= nbuffer();
+    else {
+      LeftVal = left;
+      RightVal = right;
+    }
+    block1->data[i] = LeftVal;
+    if (numConnections > 1)
+      block2->data[i] = RightVal;
+    size_t n = Resample.advance();
+    for (size_t k=0; k<n; k++) {
+      if (MixPos >= MixN)
+	mixFrames();
+      Resample.push(MixLeft[MixPos], MixRight[MixPos]);
+      MixPos++;
     }
   }
-  Time -= time(Index - start);  // keep time mismatch!
 
   transmit(block1, 0);
   release(block1);
@@ -89,35 +144,244 @@ void AudioPlayBuffer::update() {
 }
 
 
-void AudioPlayBuffer::average(int16_t &left, int16_t &right) {
+void AudioPlayBuffer::mixFrames() {
   uint8_t nchans = nchannels();
-  int16_t val = 0;
-  for (uint8_t c=0; c<nchans; c++)
-    val += Data->buffer()[Index+c]/nchans;
-  left = val;
-  right = val;
+  uint8_t nmix = nchans < MaxChannels ? nchans : MaxChannels;
+  // contiguous frames up to the end of the data buffer:
+  size_t nframes = (nbuffer() - Index)/nchans;
+  size_t navail = available()/nchans;
+  if (nframes > navail)
+    nframes = navail;
+  if (nframes > MixFrames)
+    nframes = MixFrames;
+  MixPos = 0;
+  if (navail == 0) {
+    // should not happen, repeat last frame:
+    MixLeft[0] = MixLeft[MixN > 0 ? MixN - 1 : 0];
+    MixRight[0] = MixRight[MixN > 0 ? MixN - 1 : 0];
+    MixN = 1;
+    return;
+  }
+  const volatile sample_t *buffer = &Data->buffer()[Index];
+  sample_t frame[MaxChannels];
+  if (nframes == 0) {
+    // frame straddles the end of the data buffer:
+    for (uint8_t c=0; c<nmix; c++) {
+      size_t idx = Index + c;
+      if (idx >= nbuffer())
+	idx -= nbuffer();
+      frame[c] = Data->buffer()[idx];
+    }
+    buffer = frame;
+    nframes = 1;
+  }
+  for (size_t k=0; k<nframes; k++) {
+    int32_t left = 0;
+    int32_t right = 0;
+    for (uint8_t c=0; c<nmix; c++) {
+      int32_t x = buffer[c];
+      left += WeightLeft[c]*x;
+      right += WeightRight[c]*x;
+    }
+    left >>= 15;
+    right >>= 15;
+    MixLeft[k] = left > 32767 ? 32767 : (left < -32768 ? -32768 : left);
+    MixRight[k] = right > 32767 ? 32767 : (right < -32768 ? -32768 : right);
+    buffer += nchans;
+  }
+  MixN = nframes;
+  increment(nframes*nchans);
+  switch (Mode) {
+  case HETERODYNE:
+    heterodyne(nframes);
+    break;
+  case DIVISION:
+    divide(MixLeft, nframes, DivLeft);
+    divide(MixRight, nframes, DivRight);
+    break;
+  default:
+    break;
+  }
+}
+
+
+void AudioPlayBuffer::heterodyne(size_t nframes) {
+  uint32_t phase = Phase;
+  uint32_t step = PhaseStep;
+  for (size_t k=0; k<nframes; k++) {
+    // the upper 10 bits of the phase index the sine table:
+    int32_t osc = Sine[phase >> 22];
+    phase += step;
+    // mixing halves the amplitude of each sideband, compensate by 2:
+    int32_t left = (MixLeft[k]*osc) >> 14;
+    int32_t right = (MixRight[k]*osc) >> 14;
+    MixLeft[k] = left > 32767 ? 32767 : (left < -32768 ? -32768 : left);
+    MixRight[k] = right > 32767 ? 32767 : (right < -32768 ? -32768 : right);
+  }
+  Phase = phase;
+}
+
+
+void AudioPlayBuffer::divide(int16_t *data, size_t nframes, int32_t *state) {
+  int32_t sign = state[0];
+  int32_t counter = state[1];
+  int32_t out = state[2];
+  int32_t envelope = state[3];
+  for (size_t k=0; k<nframes; k++) {
+    int32_t x = data[k];
+    // zero crossings with hysteresis:
+    if ((sign >= 0 && x < -Threshold) || (sign < 0 && x > Threshold)) {
+      sign = -sign;
+      if (++counter >= Factor) {
+	counter = 0;
+	out = -out;
+      }
+    }
+    // envelope as peak follower, limited to the int16 range:
+    if (x < 0)
+      x = -x;
+    if (x > 32767)
+      x = 32767;
+    if (x > envelope)
+      envelope = x;
+    else
+      envelope -= envelope >> 8;
+    data[k] = out*envelope;
+  }
+  state[0] = sign;
+  state[1] = counter;
+  state[2] = out;
+  state[3] = envelope;
 }
 
 
-void AudioPlayBuffer::difference(int16_t &left, int16_t &right) {
-  if (nchannels() > 1) { 
-    int16_t diff = Data->buffer()[Index]/2 - Data->buffer()[Index+1]/2;
-    left = diff;
-    right = -diff;
+void AudioPlayBuffer::setDirect() {
+  Mode = DIRECT;
+}
+
+
+void AudioPlayBuffer::setHeterodyne(float freq) {
+  if (Sine[NSine/4] == 0) {
+    for (size_t k=0; k<NSine; k++)
+      Sine[k] = (int16_t)(32767*sin(2.0*PI*k/NSine));
   }
-  else {
-    left = Data->buffer()[Index];
-    right = left;
+  HeterodyneFreq = freq;
+  if (Producer != 0 && rate() > 0)
+    PhaseStep = (uint32_t)(freq/rate()*4294967296.0);
+  Mode = HETERODYNE;
+}
+
+
+void AudioPlayBuffer::setDivision(uint8_t factor, float threshold) {
+  Factor = factor > 0 ? factor : 1;
+  Threshold = 32767*threshold;
+  for (int k=0; k<4; k++) {
+    DivLeft[k] = 0;
+    DivRight[k] = 0;
+  }
+  DivLeft[0] = 1;
+  DivLeft[2] = 1;
+  DivRight[0] = 1;
+  DivRight[2] = 1;
+  Mode = DIVISION;
+}
+
+
+void AudioPlayBuffer::setExpansion(uint8_t factor) {
+  Factor = factor > 0 ? factor : 1;
+  Mode = EXPANSION;
+}
+
+
+void AudioPlayBuffer::average() {
+  MixMode = AVERAGE;
+  if (Producer != 0)
+    computeWeights(nchannels());
+}
+
+
+void AudioPlayBuffer::difference() {
+  MixMode = DIFFERENCE;
+  if (Producer != 0)
+    computeWeights(nchannels());
+}
+
+
+void AudioPlayBuffer::assign() {
+  MixMode = ASSIGN;
+  if (Producer != 0)
+    computeWeights(nchannels());
+}
+
+
+void AudioPlayBuffer::setMixer(const float *left, const float *right,
+			       uint8_t nchannels) {
+  for (uint8_t c=0; c<MaxChannels; c++) {
+    CustomLeft[c] = c < nchannels ? left[c] : 0.0;
+    CustomRight[c] = c < nchannels ? right[c] : 0.0;
   }
+  MixMode = CUSTOM;
+  if (Producer != 0)
+    computeWeights(this->nchannels());
 }
 
 
-void AudioPlayBuffer::assign(int16_t &left, int16_t &right) {
-  left = Data->buffer()[Index];
-  if (nchannels() > 1)
-    right = Data->buffer()[Index+1];
-  else
-    right = left;
+void AudioPlayBuffer::setupMixer() {
+  if (Producer != 0 && MixChannels != nchannels())
+    computeWeights(nchannels());
+}
+
+
+void AudioPlayBuffer::computeWeights(uint8_t nchannels) {
+  if (nchannels == 0)
+    return;
+  if (nchannels > MaxChannels) {
+    Serial.printf("WARNING in AudioPlayBuffer: can mix only the first %u of %u channels.\n", MaxChannels, nchannels);
+  }
+  uint8_t nmix = nchannels < MaxChannels ? nchannels : MaxChannels;
+  float left[MaxChannels];
+  float right[MaxChannels];
+  for (uint8_t c=0; c<MaxChannels; c++) {
+    left[c] = 0.0;
+    right[c] = 0.0;
+  }
+  switch (MixMode) {
+  case AVERAGE:
+    for (uint8_t c=0; c<nmix; c++) {
+      left[c] = 1.0/nmix;
+      right[c] = 1.0/nmix;
+    }
+    break;
+  case DIFFERENCE:
+    if (nchannels > 1) {
+      left[0] = 0.5;
+      left[1] = -0.5;
+      right[0] = -0.5;
+      right[1] = 0.5;
+    }
+    else {
+      left[0] = 1.0;
+      right[0] = 1.0;
+    }
+    break;
+  case ASSIGN:
+    left[0] = 1.0;
+    right[nchannels > 1 ? 1 : 0] = 1.0;
+    break;
+  case CUSTOM:
+    for (uint8_t c=0; c<MaxChannels; c++) {
+      left[c] = CustomLeft[c];
+      right[c] = CustomRight[c];
+    }
+    break;
+  }
+  AudioNoInterrupts();
+  for (uint8_t c=0; c<MaxChannels; c++) {
+    WeightLeft[c] = left[c] >= 1.0 ? 32767 : (left[c] <= -1.0 ? -32768 : int16_t(32768*left[c]));
+    WeightRight[c] = right[c] >= 1.0 ? 32767 : (right[c] <= -1.0 ? -32768 : int16_t(32768*right[c]));
+  }
+  MixChannels = nchannels;
+  AudioInterrupts();
 }
 
 
@@ -3,6 +3,16 @@
   Created by Jan Benda, July 2nd, 2021.
 */
 
+/*
+  The data are resampled to the audio sampling rate. The resampler
+  is not set up automatically, since this takes too long for the
+  audio interrupt. AudioMonitor takes care of this. If you use an
+  AudioPlayBuffer on its own, call setupResampler() after the data
+  acquisition has been started and whenever the sampling rate or the
+  number of channels changed, e.g. regularly from loop(). Otherwise
+  the AudioPlayBuffer stays silent.
+*/
+
 #ifndef AudioPlayBuffer_h
 #define AudioPlayBuffer_h
 
@@ -10,6 +20,7 @@
 #include <Arduino.h>
 #include <Audio.h>
 #include <DataWorker.h>
+#include <Resampler.h>
 
 
 class AudioPlayBuffer : public DataWorker, public AudioStream {
@@ -19,43 +30,153 @@ class AudioPlayBuffer : public DataWorker, public AudioStream {
   AudioPlayBuffer();
   AudioPlayBuffer(const DataWorker &producer);
   virtual ~AudioPlayBuffer();
+
+  // Set up the resampler for the current sampling rate and the mixer
+  // for the current number of channels of the data if they changed.
+  // Call this from loop() or after starting the data acquisition,
+  // since it takes some time. Until the resampler is set up, update()
+  // does not output any data. AudioMonitor::update() calls this for you.
+  // Return false if the resampler could not be set up.
+  bool setupResampler();
   
+  // Resample the data to the audio sampling rate and transmit them.
+  // Called by the Audio library.
   virtual void update();
 
-  // Set low-pass filter time-constant to n/44.1kHz, default is 10.
+  // Set time-constant of an additional low-pass filter smoothing the
+  // resampled audio signal to n/44.1kHz, default is 1.
+  // Anti-aliasing is already done by the resampler, n equal to one
+  // disables the additional smoothing.
   // Must be larger or equal to one.
   void setLowpass(int16_t n);
 
   void setMute(bool mute=true);
 
-  typedef void (AudioPlayBuffer::*MixerFunc)(int16_t &left, int16_t &right);
-  
-  // Compute the average of all channels at the current index of the
-  // data buffer and copy it to both the left and right channel.
-  void average(int16_t &left, int16_t &right);
+  // Modes for monitoring ultrasound.
+  enum MODE {
+    DIRECT,      // play data as they are.
+    HETERODYNE,  // shift frequencies down by a tunable oscillator.
+    DIVISION,    // divide frequencies by a factor.
+    EXPANSION    // play data slowed down by a factor.
+  };
+
+  // Current monitoring mode.
+  MODE mode() const { return Mode; };
+
+  // Play data directly (default).
+  void setDirect();
+
+  // Multiply the data with a sine wave of freq Hertz.
+  // The difference frequencies below 18kHz are audible.
+  void setHeterodyne(float freq);
+
+  // Frequency of the heterodyne oscillator in Hertz.
+  float heterodyneFrequency() const { return HeterodyneFreq; };
+
+  // Replace the data by a square wave with the frequency of the data
+  // divided by factor and the amplitude of the data's envelope.
+  // Zero crossings are detected with a hysteresis of threshold
+  // relative to full range.
+  void setDivision(uint8_t factor, float threshold=0.005);
+
+  // Play data slowed down by factor. Only snippets of the data
+  // can be played, data arriving while playing a snippet are skipped.
+  void setExpansion(uint8_t factor);
+
+  // Factor of frequency division or time expansion.
+  uint8_t factor() const { return Factor; };
+
+  // Sampling rate of the data as fed into the resampler.
+  // Reduced by the factor of time expansion.
+  float inputRate() const;
+
+  // Maximum number of data channels that can be mixed.
+  static const uint8_t MaxChannels = 32;
+
+  // The channels of the data buffer are mixed into a left and a
+  // right audio channel by a matrix of weights in Q15 fixed point,
+  // block by block. The resampler then converts the stream of mixed
+  // frames to the audio sampling rate.
+  // The following mixer functions set these weights.
+  typedef void (AudioPlayBuffer::*MixerFunc)();
   
-  // Subtract the second data channel at the current Index from the
-  // first.  Divide by two and assign this to the left audio channel
-  // and the negative to the right one.
-  void difference(int16_t &left, int16_t &right);
+  // Average all channels and copy the average to both the left
+  // and right channel. This is the default.
+  void average();
   
-  // Assign the first channel at the current index of the data buffer
-  // to left, and the second one to the right audio channel.
-  void assign(int16_t &left, int16_t &right);
+  // Subtract the second data channel from the first. Divide by two
+  // and assign this to the left audio channel and the negative to
+  // the right one.
+  void difference();
   
-  // Assign one of the above functions to mixer for mapping all
-  // channels of the data producer to the left and right channel of
-  // audio output.  By default the average() function is assigned..
-  MixerFunc mixer;
+  // Assign the first channel of the data buffer to left, and the
+  // second one to the right audio channel.
+  void assign();
+
+  // Mix the first nchannels channels of the data buffer with weights
+  // left into the left and with weights right into the right audio
+  // channel. Weights must be between -1 and 1 and should add up to
+  // at maximum one.
+  void setMixer(const float *left, const float *right, uint8_t nchannels);
+
+  // Compute the weight matrix for the current number of channels
+  // if it changed. Called by setupResampler().
+  void setupMixer();
 
   
  protected:
 
-  float Time;
+  enum MIXER {
+    AVERAGE,
+    DIFFERENCE,
+    ASSIGN,
+    CUSTOM
+  };
+
+  // Set the Q15 weight matrix according to MixMode and nchannels.
+  void computeWeights(uint8_t nchannels);
+
+  // Mix the next frames of the data buffer into MixLeft and MixRight.
+  void mixFrames();
+
+  // Shift frequencies of the nframes in MixLeft and MixRight by
+  // the heterodyne oscillator.
+  void heterodyne(size_t nframes);
+
+  // Divide frequencies of the nframes frames in data.
+  // state holds sign, counter, output sign, and envelope.
+  void divide(int16_t *data, size_t nframes, int32_t *state);
+
+  Resampler Resample;
   bool Mute;
   int16_t LeftVal;
   int16_t RightVal;
   int16_t LowpassN;
+
+  MIXER MixMode;
+  float CustomLeft[MaxChannels];
+  float CustomRight[MaxChannels];
+  uint8_t MixChannels;       // number of input channels the weights were computed for,
+                             // only the first MaxChannels of them are mixed.
+  int16_t WeightLeft[MaxChannels];
+  int16_t WeightRight[MaxChannels];
+
+  volatile MODE Mode;
+  float HeterodyneFreq;
+  uint32_t Phase;           // phase of heterodyne oscillator.
+  volatile uint32_t PhaseStep;
+  static const size_t NSine = 1024;
+  static int16_t Sine[NSine];
+  uint8_t Factor;
+  int16_t Threshold;
+  int32_t DivLeft[4];
+  int32_t DivRight[4];
+
+  static const size_t MixFrames = 128;
+  int16_t MixLeft[MixFrames];
+  int16_t MixRight[MixFrames];
+  size_t MixPos;             // next mixed frame to be resampled.
+  size_t MixN;               // number of mixed frames.
   
 };
 
@@ -0,0 +1,73 @@
+#include <BandEnergyDetector.h>
+
+
+BandEnergyDetector::BandEnergyDetector(float flow, float fhigh,
+				       float threshold, float window) :
+  RMSDetector(threshold, window),
+  FLow(flow),
+  FHigh(fhigh),
+  B0(0),
+  B2(0),
+  A1(0),
+  A2(0),
+  State(0) {
+}
+
+
+BandEnergyDetector::~BandEnergyDetector() {
+  if (State != 0)
+    free(State);
+}
+
+
+void BandEnergyDetector::setBand(float flow, float fhigh) {
+  FLow = flow;
+  FHigh = fhigh;
+}
+
+
+void BandEnergyDetector::start(uint8_t nchannels, float rate,
+			       uint8_t dataresolution) {
+  RMSDetector::start(nchannels, rate, dataresolution);
+  if (State != 0)
+    free(State);
+  State = (float *)calloc(4*NChannels, sizeof(float));
+  if (State == 0) {
+    Serial.println("ERROR in BandEnergyDetector::start(): not enough memory for filter state.");
+    return;
+  }
+  float fhigh = FHigh;
+  if (fhigh > 0.45*Rate)
+    fhigh = 0.45*Rate;
+  float flow = FLow;
+  if (flow < 1.0)
+    flow = 1.0;
+  if (fhigh <= flow) {
+    Serial.printf("WARNING in BandEnergyDetector::start(): invalid frequency band from %.0fHz to %.0fHz.\n", FLow, FHigh);
+    fhigh = 1.1*flow;
+  }
+  // band-pass biquad with 0dB peak gain (Audio EQ Cookbook):
+  float f0 = sqrt(flow*fhigh);
+  float q = f0/(fhigh - flow);
+  float w0 = 2.0*PI*f0/Rate;
+  float alpha = sin(w0)/(2.0*q);
+  float a0 = 1.0 + alpha;
+  B0 = alpha/a0;
+  B2 = -alpha/a0;
+  A1 = -2.0*cos(w0)/a0;
+  A2 = (1.0 - alpha)/a0;
+}
+
+
+float BandEnergyDetector::value(sample_t x) {
+  if (State == 0)
+    return 0.0;
+  float *s = &State[4*CChannel];
+  float xn = x*Scale;
+  float yn = B0*xn + B2*s[1] - A1*s[2] - A2*s[3];
+  s[1] = s[0];
+  s[0] = xn;
+  s[3] = s[2];
+  s[2] = yn;
+  return yn;
+}
@@ -0,0 +1,59 @@
+/*
+  BandEnergyDetector - Detect events by thresholding the RMS of a frequency band.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+#ifndef BandEnergyDetector_h
+#define BandEnergyDetector_h
+
+
+#include <RMSDetector.h>
+
+
+class BandEnergyDetector : public RMSDetector {
+
+ public:
+
+  // Construct detector for the frequency band between flow and fhigh
+  // Hertz with a threshold for the RMS of the band-pass filtered
+  // signal relative to the full range of the data (between 0 and 1)
+  // computed on consecutive windows of window seconds.
+  BandEnergyDetector(float flow, float fhigh, float threshold=0.1,
+		     float window=0.01);
+  ~BandEnergyDetector();
+
+  // Lower edge of the frequency band in Hertz.
+  float lowFrequency() const { return FLow; };
+
+  // Upper edge of the frequency band in Hertz.
+  float highFrequency() const { return FHigh; };
+
+  // Set the frequency band. Takes effect at the next call of start().
+  void setBand(float flow, float fhigh);
+
+  // Initialize the band-pass filter and the RMS computation.
+  virtual void start(uint8_t nchannels, float rate,
+		     uint8_t dataresolution=16);
+
+
+ protected:
+
+  // Band-pass filter sample x of the current channel CChannel.
+  virtual float value(sample_t x);
+
+  float FLow;
+  float FHigh;
+
+  // Coefficients of the band-pass biquad filter:
+  float B0;
+  float B2;
+  float A1;
+  float A2;
+
+  // Filter state of each channel (x1, x2, y1, y2):
+  float *State;
+
+};
+
+
+#endif
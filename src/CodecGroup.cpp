@@ -0,0 +1,74 @@
+#include <CodecGroup.h>
+
+
+CodecGroup::CodecGroup() :
+  NCodecs(0) {
+  for (size_t k=0; k<MaxCodecs; k++)
+    Codecs[k] = 0;
+}
+
+
+bool CodecGroup::add(ControlPCM186x &pcm) {
+  return add(pcm.registers());
+}
+
+
+bool CodecGroup::add(ControlTLV320ADC &tlv) {
+  return add(tlv.registers());
+}
+
+
+bool CodecGroup::add(RegisterCache &registers) {
+  if (NCodecs >= MaxCodecs) {
+    Serial.printf("ERROR in CodecGroup::add(): no more than %d codecs allowed.\n", MaxCodecs);
+    return false;
+  }
+  Codecs[NCodecs++] = &registers;
+  return true;
+}
+
+
+void CodecGroup::beginBatch() {
+  for (size_t k=0; k<NCodecs; k++)
+    Codecs[k]->beginBatch();
+}
+
+
+bool CodecGroup::flush() {
+  for (size_t k=0; k<NCodecs; k++)
+    Codecs[k]->endBatch();
+  bool success = true;
+  int reg = 0;
+  while (reg < RegisterCache::NRegisters) {
+    // next dirty register of any of the codecs:
+    int next = -1;
+    for (size_t k=0; k<NCodecs; k++) {
+      if (Codecs[k]->batching())
+	continue;
+      int r = Codecs[k]->nextDirty(reg);
+      if (r >= 0 && (next < 0 || r < next))
+	next = r;
+    }
+    if (next < 0)
+      break;
+    // write run starting at this register to all codecs:
+    for (size_t k=0; k<NCodecs; k++) {
+      if (!Codecs[k]->batching() && Codecs[k]->nextDirty(next) == next) {
+	if (!Codecs[k]->writeRun(next))
+	  success = false;
+      }
+    }
+    reg = next + 1;
+  }
+  return success;
+}
+
+
+bool CodecGroup::verify() {
+  bool success = true;
+  for (size_t k=0; k<NCodecs; k++) {
+    if (!Codecs[k]->verify())
+      success = false;
+  }
+  return success;
+}
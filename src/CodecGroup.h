@@ -0,0 +1,86 @@
+/*
+  CodecGroup - Configure several codec chips in one pass.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+/*
+  Between beginBatch() and flush() all register writes of the codecs
+  in the group are only recorded in their register caches. flush()
+  then writes the changed registers of all codecs interleaved in
+  address order, with consecutive registers of each codec in a single
+  burst transaction. Identical settings thus reach all codecs within
+  a few I2C transactions of each other. This speeds up booting and
+  keeps gain changes of several codecs synchronized during
+  recording. verify() reads back the written registers of all codecs
+  in a single pass of burst reads.
+
+  Call begin() of the codecs before beginBatch(), because it resets
+  their register caches.
+
+  Usage:
+
+  CodecGroup codecs;
+  codecs.add(pcm1);
+  codecs.add(pcm2);
+  pcm1.begin();
+  pcm2.begin();
+  codecs.beginBatch();
+  pcm1.setupChannels(...);
+  pcm2.setupChannels(...);
+  pcm1.setGainDecibel(tdm, 20.0);
+  pcm2.setGainDecibel(tdm, 20.0);
+  codecs.flush();
+  codecs.verify();
+*/
+
+#ifndef CodecGroup_h
+#define CodecGroup_h
+
+
+#include <Arduino.h>
+#include <RegisterCache.h>
+#include <ControlPCM186x.h>
+#include <ControlTLV320ADC.h>
+
+
+class CodecGroup {
+
+ public:
+
+  static const size_t MaxCodecs = 8;
+
+  // Construct empty group.
+  CodecGroup();
+
+  // Number of codecs in the group.
+  size_t size() const { return NCodecs; };
+
+  // Add codec to the group.
+  // Return false if the group is already full.
+  bool add(ControlPCM186x &pcm);
+  bool add(ControlTLV320ADC &tlv);
+  bool add(RegisterCache &registers);
+
+  // Defer register writes of all codecs until flush().
+  void beginBatch();
+
+  // Write the changed registers of all codecs interleaved in address
+  // order using burst transactions.
+  // Return false on I2C error.
+  bool flush();
+
+  // Read back the registers written to all codecs and compare them
+  // with the requested values.
+  // Return false on mismatch or I2C error.
+  bool verify();
+
+
+ protected:
+
+  RegisterCache *Codecs[MaxCodecs];
+  size_t NCodecs;
+
+};
+
+
+#endif
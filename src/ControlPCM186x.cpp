@@ -147,7 +147,7 @@ ControlPCM186x::ControlPCM186x(TwoWire &wire, uint8_t address,
   Device(),
   I2CBus(&wire),
   I2CAddress(address),
-  CurrentPage(10),
+  Registers(wire, address, 3, WriteDelay),
   PGALinked(false),
   NChannels(0),
   Bus(bus),
@@ -156,6 +156,12 @@ ControlPCM186x::ControlPCM186x(TwoWire &wire, uint8_t address,
   GainStr("0dB") {
   for (uint8_t c=0; c<4; c++)
     UseChannel[c] = false;
+  // status registers:
+  Registers.setVolatile(PCM186x_GPIO_INOUT_REG, PCM186x_GPIO_INOUT_REG);
+  Registers.setVolatile(PCM186x_SIGDET_STAT_REG, PCM186x_SIGDET_STAT_REG);
+  Registers.setVolatile(PCM186x_AUXADC_DATA0_REG, PCM186x_AUXADC_DATA1_REG);
+  Registers.setVolatile(PCM186x_INT_STAT_REG, PCM186x_INT_STAT_REG);
+  Registers.setVolatile(PCM186x_DEV_STAT_REG, PCM186x_POWER_STAT_REG);
   setDeviceType("input");
   setI2CBus(wire, address);
   setChip("PCM186x");
@@ -178,8 +184,13 @@ bool ControlPCM186x::begin() {
     return false;
   
   // power up:
+  Registers.invalidate();
   if (!powerup())
     return false;
+
+  // read all configuration registers at once:
+  if (!Registers.fetch(0x01, 0x7F))
+    return false;
   
   Available = true;
   return true;
@@ -194,6 +205,7 @@ bool ControlPCM186x::begin(uint8_t address) {
 bool ControlPCM186x::begin(TwoWire &wire, uint8_t address) {
   I2CAddress = address;
   I2CBus = &wire;
+  Registers.setBus(wire, address);
   return begin();
 }
 
@@ -326,11 +338,10 @@ bool ControlPCM186x::setupChannel(OUTPUT_CHANNELS adc, INPUT_CHANNELS channel,
 bool ControlPCM186x::setupChannels(INPUT_CHANNELS channel1,
 				   INPUT_CHANNELS channel2,
 				   POLARITY polarity) {
-  if (!setupChannel(ADC1L, channel1, polarity))
-    return false;
-  if (!setupChannel(ADC1R, channel2, polarity))
-    return false;
-  return true;
+  Registers.beginBatch();
+  bool success = setupChannel(ADC1L, channel1, polarity) &&
+    setupChannel(ADC1R, channel2, polarity);
+  return Registers.flush() && success;
 }
 
 
@@ -339,15 +350,12 @@ bool ControlPCM186x::setupChannels(INPUT_CHANNELS channel1,
 				   INPUT_CHANNELS channel3,
 				   INPUT_CHANNELS channel4,
 				   POLARITY polarity) {
-  if (!setupChannel(ADC1L, channel1, polarity))
-    return false;
-  if (!setupChannel(ADC1R, channel2, polarity))
-    return false;
-  if (!setupChannel(ADC2L, channel3, polarity))
-    return false;
-  if (!setupChannel(ADC2R, channel4, polarity))
-    return false;
-  return true;
+  Registers.beginBatch();
+  bool success = setupChannel(ADC1L, channel1, polarity) &&
+    setupChannel(ADC1R, channel2, polarity) &&
+    setupChannel(ADC2L, channel3, polarity) &&
+    setupChannel(ADC2R, channel4, polarity);
+  return Registers.flush() && success;
 }
 
 
@@ -403,19 +411,17 @@ bool ControlPCM186x::setupTDM(bool offs) {
   val |= bits << 2;    // TX_WLEN
   val |= 0x10;         // TDM_LRCK_MODE
   val |= bits << 6;    // RX_WLEN
-  if (!writePCM(PCM186x_I2S_FMT_REG, val))
-    return false;
+  Registers.beginBatch();
+  bool success = writePCM(PCM186x_I2S_FMT_REG, val);
   // number of ADCs:
   if (NChannels == 4)
     val = 0x01;        // TDM_OSEL: 4 channel TDM
   else
     val = 0x00;        // TDM_OSEL: 2 channel TDM
-  if (!writePCM(PCM186x_I2S_TDM_OSEL_REG, val))
-      return false;
+  success = success && writePCM(PCM186x_I2S_TDM_OSEL_REG, val);
   val = offs ? 0x80 : 0x00; // TX_TDM_OFFSET
-  if (!writePCM(PCM186x_I2S_TX_OFFSET_REG, val))
-    return false;
-  return true;  
+  success = success && writePCM(PCM186x_I2S_TX_OFFSET_REG, val);
+  return Registers.flush() && success;
 }
 
 
@@ -479,42 +485,35 @@ float ControlPCM186x::setGainDecibel(OUTPUT_CHANNELS adc, float level) {
   }
   // set levels:
   int8_t igain = (int8_t)(2*level);
+  bool success = true;
+  Registers.beginBatch();
   if (adc == ADCLR) {
     if (!PGALinked) {
       unsigned int val = readPCM(PCM186x_PGA_CONTROL_REG);
       val |= 0x40;
-      if (!writePCM(PCM186x_PGA_CONTROL_REG, val))
-	return NAN;
+      success = success && writePCM(PCM186x_PGA_CONTROL_REG, val);
       PGALinked = true;
     }
-    if (!writePCM(PCM186x_PGA_CH1L_REG, igain))
-      return NAN;
+    success = success && writePCM(PCM186x_PGA_CH1L_REG, igain);
   }
   else {
     if (PGALinked) {
       unsigned int val = readPCM(PCM186x_PGA_CONTROL_REG);
       val &= ~0x40;
-      if (!writePCM(PCM186x_PGA_CONTROL_REG, val))
-	return NAN;
+      success = success && writePCM(PCM186x_PGA_CONTROL_REG, val);
       PGALinked = false;
     }
-    if (adc & ADC1L) {
-      if (!writePCM(PCM186x_PGA_CH1L_REG, igain))
-	return NAN;
-    }
-    if (adc & ADC1R) {
-      if (!writePCM(PCM186x_PGA_CH1R_REG, igain))
-	return NAN;
-    }
-    if (adc & ADC2L) {
-      if (!writePCM(PCM186x_PGA_CH2L_REG, igain))
-	return NAN;
-    }
-    if (adc & ADC2R) {
-      if (!writePCM(PCM186x_PGA_CH2R_REG, igain))
-	return NAN;
-    }
+    if (adc & ADC1L)
+      success = success && writePCM(PCM186x_PGA_CH1L_REG, igain);
+    if (adc & ADC1R)
+      success = success && writePCM(PCM186x_PGA_CH1R_REG, igain);
+    if (adc & ADC2L)
+      success = success && writePCM(PCM186x_PGA_CH2L_REG, igain);
+    if (adc & ADC2R)
+      success = success && writePCM(PCM186x_PGA_CH2R_REG, igain);
   }
+  if (!Registers.flush() || !success)
+    return NAN;
   snprintf(GainStr, 8, "%.1fdB", 0.5*igain);
   GainStr[7] = '\0';
   return 0.5*igain;
@@ -632,7 +631,7 @@ bool ControlPCM186x::powerdown() {
   if (!writePCM(PCM186x_PWRDN_CTRL_REG, val))
     return false;
   
-  CurrentPage = 10;
+  Registers.invalidate();
   for (uint8_t c=0; c<4; c++)
     UseChannel[c] = false;
   NChannels = 0;
@@ -641,7 +640,6 @@ bool ControlPCM186x::powerdown() {
 
 
 bool ControlPCM186x::powerup() {
-  CurrentPage = 10;
   for (uint8_t c=0; c<4; c++)
     UseChannel[c] = false;
   NChannels = 0;
@@ -832,17 +830,6 @@ float ControlPCM186x::readCoefficient(uint8_t address) {
   float coeff = 0.0;
   uint32_t frac = 0;
   unsigned int val;
-  uint8_t result;
-  uint8_t page = 0x01;
-  if (CurrentPage != page) {
-    result = goToPage(page);
-    result = goToPage(page);
-    result = goToPage(page);
-    if (result != 0) {
-      Serial.printf("ControlPCM186x: readCoefficient() failed to go to page %02x, error = %02x\n", page, result);
-      return -1.0;
-    }
-  }
   val = 0;
   for (int n=0; n < 10 && val == 0; n++) {
     val = readPCM(0x0101);
@@ -873,91 +860,17 @@ float ControlPCM186x::readCoefficient(uint8_t address) {
 
 
 unsigned int ControlPCM186x::readPCM(uint16_t address) {
-  uint8_t reg = (uint8_t) (address & 0xFF);
-  uint8_t page = (uint8_t) ((address >> 8) & 0xFF);
-  uint8_t result;
-  
-  if (CurrentPage != page) {
-    // switch page (three times, see page 68 of the data sheet):
-    result = goToPage(page);
-    result = goToPage(page);
-    result = goToPage(page);
-    if (result != 0) {
-#ifdef DEBUG
-      Serial.printf("ControlPCM186x: readPCM() failed to go to page %02x, error = %02x\n", page, result);
-#endif
-      return 0x0100;
-    }
-  }
-  
-  I2CBus->beginTransmission(I2CAddress);
-  I2CBus->write(reg);
-  result = I2CBus->endTransmission(false);
-  if (result != 0) {
-#ifdef DEBUG
-    Serial.printf("ControlPCM186x: readPCM() failed to write reg %02x on page %02x, error = %02x\n", reg, page, result);
-#endif
-    return 0x0200 + result;
-  }
-  if (I2CBus->requestFrom(I2CAddress, (uint8_t)1) < 1) {
-    Serial.printf("ControlPCM186x: empty readPCM() on page %02x reg %02x\n", page, reg);
-    return 0x0400;
-  }
-  int val = I2CBus->read();
+  unsigned int val = Registers.read(address);
 #ifdef DEBUG
-    Serial.printf("ControlPCM186x: read page %02x, reg %02x, val %02x\n", page, reg, val);
+  Serial.printf("ControlPCM186x: read page %02x, reg %02x, val %02x\n", address >> 8, address & 0xFF, val);
 #endif
   return val;
 }
 
 
 bool ControlPCM186x::writePCM(uint16_t address, uint8_t val) {
-  uint8_t reg = (uint8_t) (address & 0xFF);
-  uint8_t page = (uint8_t) ((address >> 8) & 0xFF);
-  uint8_t result;
-  
-#ifdef DEBUG
-  Serial.printf("ControlPCM186x: write page %02x, reg %02x, val %02x\n", page, reg, val);
-#endif
-
-  if (CurrentPage != page) {
-    // switch page (three times, see page 68 of the data sheet):
-    result = goToPage(page);
-    result = goToPage(page);
-    result = goToPage(page);
-    if (result != 0) {
 #ifdef DEBUG
-      Serial.printf("ControlPCM186x: writePCM() failed to go to page %02x, error = %02x\n", page, result);
+  Serial.printf("ControlPCM186x: write page %02x, reg %02x, val %02x\n", address >> 8, address & 0xFF, val);
 #endif
-      return false;
-    }
-  }
-    
-  I2CBus->beginTransmission(I2CAddress);
-  I2CBus->write(reg);
-  delay(WriteDelay);
-  I2CBus->write(val);
-  delay(WriteDelay);
-  result = I2CBus->endTransmission();
-  if (result != 0) {
-#ifdef DEBUG
-    Serial.printf("ControlPCM186x: writePCM() failed, error = %02x\n", result);
-#endif
-    return false;
-  }
-  return true;
-}
-
-
-uint8_t ControlPCM186x::goToPage(byte page) {
-  I2CBus->beginTransmission(I2CAddress);
-  I2CBus->write(0x00); // page register
-  delay(WriteDelay);
-  I2CBus->write(page); // go to page
-  delay(WriteDelay);
-  uint8_t result = I2CBus->endTransmission();
-  if (result == 0)
-    CurrentPage = page;
-  return result;
+  return Registers.write(address, val);
 }
-
@@ -11,6 +11,7 @@
 #include <Wire.h>
 #include <Device.h>
 #include <InputTDM.h>
+#include <RegisterCache.h>
 
 
 #define PCM186x_I2C_ADDR1     0x4A
@@ -100,6 +101,11 @@ public:
   /* Initialize PCM186x with address (one of PCM186x_I2C_ADDR*) on I2C bus.
      You need to initialize I2C by calling `wire.begin()` before. */
   bool begin(TwoWire &wire, uint8_t address=PCM186x_I2C_ADDR1);
+
+  /* Cached registers of the chip.
+     Use beginBatch() and flush() for writing several settings at once,
+     or a CodecGroup for configuring several chips. */
+  RegisterCache &registers() { return Registers; };
   
   // Set sampling rate per channel in Hertz.
   void setRate(InputTDM &tdm, uint32_t rate);
@@ -226,13 +232,12 @@ protected:
     
   unsigned int readPCM(uint16_t address);
   bool writePCM(uint16_t address, uint8_t val);
-  uint8_t goToPage(uint8_t page);
 
   float readCoefficient(uint8_t address);
 
   TwoWire *I2CBus;
   uint8_t I2CAddress;
-  uint8_t CurrentPage;
+  RegisterCache Registers;
   bool PGALinked;
   bool UseChannel[4];
   int NChannels;
@@ -123,7 +123,7 @@ ControlTLV320ADC::ControlTLV320ADC(TwoWire &wire, uint8_t address,
   Device(),
   I2CBus(&wire),
   I2CAddress(address),
-  CurrentPage(10),
+  Registers(wire, address, 1, WriteDelay),
   Rate(0),
   Bits(BIT32),
   Source(Input::DIFFERENTIAL),
@@ -140,6 +140,14 @@ ControlTLV320ADC::ControlTLV320ADC(TwoWire &wire, uint8_t address,
 {
   for (uint8_t c=0; c<4; c++)
     UseChannel[c] = 0;
+  // reset and status registers:
+  Registers.setVolatile(TLV320_SW_RESET_REG, TLV320_SW_RESET_REG);
+  Registers.setVolatile(TLV320_ASI_STS_REG, TLV320_ASI_STS_REG);
+  Registers.setVolatile(TLV320_GPIO_MON_REG, TLV320_GPIO_MON_REG);
+  Registers.setVolatile(TLV320_GPI_MON_REG, TLV320_GPI_MON_REG);
+  Registers.setVolatile(TLV320_INT_LTCH0_REG, TLV320_INT_LTCH0_REG + 4);
+  Registers.setVolatile(TLV320_DEV_STS0_REG, TLV320_DEV_STS1_REG);
+  Registers.setVolatile(TLV320_I2C_CHKSUM_REG, TLV320_I2C_CHKSUM_REG);
   setDeviceType("input");
   setI2CBus(wire, address);
   setChip("TLV320ADC");
@@ -193,6 +201,7 @@ bool ControlTLV320ADC::begin(uint8_t address) {
 bool ControlTLV320ADC::begin(TwoWire &wire, uint8_t address) {
   I2CAddress = address;
   I2CBus = &wire;
+  Registers.setBus(wire, address);
   return begin();
 }
 
@@ -329,12 +338,13 @@ bool ControlTLV320ADC::setupChannels(uint8_t n_chans, Input::SOURCE source,
     Serial.printf("ERROR in ControlTLV320ADC::setupChannels(): too many channels %d requested.\n", n_chans);
     return false;
   }
+  Registers.beginBatch();
   for (uint8_t c=0; c<n_chans; c++) {
     setupChannel(c, source, impedance, coupling, slot, offs);
     if (slot >= 0)
       slot++;
   }
-  return true;
+  return Registers.flush();
 }
 
 
@@ -407,18 +417,16 @@ bool ControlTLV320ADC::setActive() {
       val |= 0x80 >> c;
     }
   }
-  if (!writeTLV(TLV320_IN_CH_EN_REG, val))
-    return false;
+  Registers.beginBatch();
+  bool success = writeTLV(TLV320_IN_CH_EN_REG, val);
   // enable output channels and put unused channels into tristate mode:
-  if (!writeTLV(TLV320_ASI_OUT_CH_EN_REG, val))
-    return false;
+  success = success && writeTLV(TLV320_ASI_OUT_CH_EN_REG, val);
   // power up:
   val = 0x60;    // power up ADC, PDM, and PLL
   if (UseBias)
     val |= 0x80;
-  if (!writeTLV(TLV320_PWR_CFG_REG, val))
-    return false;
-  return true;
+  success = success && writeTLV(TLV320_PWR_CFG_REG, val);
+  return Registers.flush() && success;
 }
 
 
@@ -646,7 +654,7 @@ bool ControlTLV320ADC::powerdown() {
     return false;
 
   Rate = 0;
-  CurrentPage = 10;
+  Registers.invalidate();
   for (uint8_t c=0; c<4; c++)
     UseChannel[c] = 0;
   NChannels = 0;
@@ -663,7 +671,7 @@ bool ControlTLV320ADC::powerdown() {
 
 bool ControlTLV320ADC::powerup() {
   Rate = 0;
-  CurrentPage = 10;
+  Registers.invalidate();
   for (uint8_t c=0; c<4; c++)
     UseChannel[c] = 0;
   NChannels = 0;
@@ -678,6 +686,7 @@ bool ControlTLV320ADC::powerup() {
   unsigned int val = 0x01;  // software reset
   if (!writeTLV(TLV320_SW_RESET_REG, val))
     return false;
+  Registers.invalidate();
   
   val = 0;
   val |= 0x01;    // set SLEEP_ENZ
@@ -686,6 +695,10 @@ bool ControlTLV320ADC::powerup() {
     return false;
   delay(10);
   
+  // read all configuration registers at once:
+  if (!Registers.fetch(TLV320_SLEEP_CFG_REG, TLV320_I2C_CHKSUM_REG))
+    return false;
+  
   val = 0x00;     // disable BIQUAD_CFG
   if (!writeTLV(TLV320_DSP_CFG1_REG, val))
     return false;
@@ -1003,85 +1016,17 @@ uint32_t ControlTLV320ADC::readCoefficient(uint8_t address) {
 
 
 unsigned int ControlTLV320ADC::readTLV(uint16_t address) {
-  uint8_t reg = (uint8_t) (address & 0xFF);
-  uint8_t page = (uint8_t) ((address >> 8) & 0xFF);
-  uint8_t result;
-  
-  if (CurrentPage != page) {
-    result = goToPage(page);
-    if (result != 0) {
-#ifdef DEBUG
-      Serial.printf("ControlTLV320ADC: readTLV() failed to go to page %02x, error = %02x\n", page, result);
-#endif
-      return 0x0100;
-    }
-  }
-  
-  I2CBus->beginTransmission(I2CAddress);
-  I2CBus->write(reg);
-  result = I2CBus->endTransmission(false);
-  if (result != 0) {
-#ifdef DEBUG
-    Serial.printf("ControlTLV320ADC: readTLV() failed to write reg %02x on page %02x, error = %02x\n", reg, page, result);
-#endif
-    return 0x0200 + result;
-  }
-  if (I2CBus->requestFrom(I2CAddress, (uint8_t)1) < 1) {
-    Serial.printf("ControlTLV320ADC: empty readTLV() on page %02x reg %02x\n", page, reg);
-    return 0x0400;
-  }
-  int val = I2CBus->read();
+  unsigned int val = Registers.read(address);
 #ifdef DEBUG
-    Serial.printf("ControlTLV320ADC: readTLV page %02x, reg %02x, val %02x\n", page, reg, val);
+  Serial.printf("ControlTLV320ADC: readTLV page %02x, reg %02x, val %02x\n", address >> 8, address & 0xFF, val);
 #endif
   return val;
 }
 
 
 bool ControlTLV320ADC::writeTLV(uint16_t address, uint8_t val) {
-  uint8_t reg = (uint8_t) (address & 0xFF);
-  uint8_t page = (uint8_t) ((address >> 8) & 0xFF);
-  uint8_t result;
-  
-#ifdef DEBUG
-  Serial.printf("ControlTLV320ADC: write page %02x, reg %02x, val %02x\n", page, reg, val);
-#endif
-
-  if (CurrentPage != page) {
-    result = goToPage(page);
-    if (result != 0) {
-#ifdef DEBUG
-      Serial.printf("ControlTLV320ADC: writeTLV() failed to go to page %02x, error = %02x\n", page, result);
-#endif
-      return false;
-    }
-  }
-    
-  I2CBus->beginTransmission(I2CAddress);
-  I2CBus->write(reg);
-  delay(WriteDelay);
-  I2CBus->write(val);
-  delay(WriteDelay);
-  result = I2CBus->endTransmission();
-  if (result != 0) {
 #ifdef DEBUG
-    Serial.printf("ControlTLV320ADC: writeTLV() failed, error = %02x\n", result);
+  Serial.printf("ControlTLV320ADC: write page %02x, reg %02x, val %02x\n", address >> 8, address & 0xFF, val);
 #endif
-    return false;
-  }
-  return true;
+  return Registers.write(address, val);
 }
-
-
-uint8_t ControlTLV320ADC::goToPage(byte page) {
-  I2CBus->beginTransmission(I2CAddress);
-  I2CBus->write(0x00); // page register
-  delay(WriteDelay);
-  I2CBus->write(page); // go to page
-  delay(WriteDelay);
-  uint8_t result = I2CBus->endTransmission();
-  if (result == 0)
-    CurrentPage = page;
-  return result;
-}
-
@@ -11,6 +11,7 @@
 #include <Wire.h>
 #include <Device.h>
 #include <InputTDM.h>
+#include <RegisterCache.h>
 
 
 #define TLV320_I2C_ADDR1     0x4C
@@ -97,6 +98,11 @@ public:
   /* Initialize TLV320 with address (one of TLV320_I2C_ADDR*) on I2C bus.
      You need to initialize I2C by calling `wire.begin()` before. */
   bool begin(TwoWire &wire, uint8_t address=TLV320_I2C_ADDR1);
+
+  /* Cached registers of the chip.
+     Use beginBatch() and flush() for writing several settings at once,
+     or a CodecGroup for configuring several chips. */
+  RegisterCache &registers() { return Registers; };
   
   /* Set sampling rate per channel in Hertz. */
   bool setRate(InputTDM &tdm, uint32_t rate);
@@ -216,7 +222,6 @@ protected:
     
   unsigned int readTLV(uint16_t address);
   bool writeTLV(uint16_t address, uint8_t val);
-  uint8_t goToPage(uint8_t page);
 
   bool setActive();
 
@@ -224,7 +229,7 @@ protected:
   
   TwoWire *I2CBus;
   uint8_t I2CAddress;
-  uint8_t CurrentPage;
+  RegisterCache Registers;
   uint32_t Rate;
   DATA_BITS Bits;
   Input::SOURCE Source;
@@ -15,6 +15,16 @@
 typedef int16_t sample_t;
 
 
+// Factor normalizing samples of data with a resolution of
+// dataresolution bits (see DataBuffer::dataResolution()) to the
+// range of -1 to 1.
+inline float sampleScale(uint8_t dataresolution) {
+  if (dataresolution < 1 || dataresolution > 16)
+    dataresolution = 16;
+  return 1.0/(1L << (dataresolution - 1));
+}
+
+
 // Macro for defining the one and only data buffer.
 // buffer and nbuffer are the variable names for the buffer and its size.
 // n defines the number of samples the buffer can hold.
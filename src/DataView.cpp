@@ -0,0 +1,96 @@
+#include <DataView.h>
+
+
+DataView::DataView() :
+  Buffer(0),
+  NBuffer(0),
+  Stride(1),
+  Start(0),
+  NChannels(0),
+  NFrames(0) {
+}
+
+
+void DataView::set(const volatile sample_t *buffer, size_t nbuffer,
+		   uint8_t stride, size_t start, uint8_t nchannels,
+		   size_t nframes) {
+  Buffer = buffer;
+  NBuffer = nbuffer;
+  Stride = stride > 0 ? stride : 1;
+  Start = start;
+  while (Start >= NBuffer && NBuffer > 0)
+    Start -= NBuffer;
+  NChannels = nchannels;
+  NFrames = nframes;
+}
+
+
+const volatile sample_t *DataView::pointer(uint8_t channel,
+					   size_t frame) const {
+  size_t idx = Start + frame*Stride + channel;
+  if (idx >= NBuffer)
+    idx -= NBuffer;
+  return &Buffer[idx];
+}
+
+
+size_t DataView::contiguous(size_t frame) const {
+  if (frame >= NFrames)
+    return 0;
+  size_t idx = Start + frame*Stride;
+  if (idx >= NBuffer)
+    idx -= NBuffer;
+  size_t n = (NBuffer - idx)/Stride;
+  if (n > NFrames - frame)
+    n = NFrames - frame;
+  return n;
+}
+
+
+void DataView::getData(uint8_t channel, sample_t *buffer) const {
+  size_t frame = 0;
+  while (frame < NFrames) {
+    size_t n = contiguous(frame);
+    if (n == 0) {
+      // frame straddles the end of the buffer:
+      buffer[frame] = at(channel, frame);
+      frame++;
+      continue;
+    }
+    const volatile sample_t *sp = pointer(channel, frame);
+    for (size_t k=0; k<n; k++, sp += Stride)
+      buffer[frame + k] = *sp;
+    frame += n;
+  }
+}
+
+
+void DataView::getData(uint8_t channel, float *buffer, float scale) const {
+  size_t frame = 0;
+  while (frame < NFrames) {
+    size_t n = contiguous(frame);
+    if (n == 0) {
+      // frame straddles the end of the buffer:
+      buffer[frame] = scale*at(channel, frame);
+      frame++;
+      continue;
+    }
+    const volatile sample_t *sp = pointer(channel, frame);
+    float *bp = buffer + frame;
+    size_t k = 0;
+    // unrolled for overlapping loads and conversions:
+    for (; k+4<=n; k+=4, sp += 4*Stride, bp += 4) {
+      float x0 = sp[0];
+      float x1 = sp[Stride];
+      float x2 = sp[2*Stride];
+      float x3 = sp[3*Stride];
+      bp[0] = scale*x0;
+      bp[1] = scale*x1;
+      bp[2] = scale*x2;
+      bp[3] = scale*x3;
+    }
+    for (; k<n; k++, sp += Stride)
+      *bp++ = scale*(*sp);
+    frame += n;
+  }
+}
@@ -0,0 +1,103 @@
+/*
+  DataView - Read-only view on a window of data in the cyclic DataBuffer.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+/*
+  A DataView gives access to nframes frames of the multiplexed data
+  directly in the cyclic data buffer without copying them.
+  If the size of the data buffer is not a multiple of the number of
+  channels multiplexed into the buffer, a frame may straddle the end
+  of the buffer. contiguous() then returns zero for this frame and
+  its samples need to be accessed with at().
+
+  Iterate efficiently over the data of a channel in contiguous
+  segments like this:
+
+  size_t frame = 0;
+  while (frame < view.frames()) {
+    size_t n = view.contiguous(frame);
+    if (n == 0) {
+      sum += view.at(channel, frame++);
+      continue;
+    }
+    const volatile sample_t *sp = view.pointer(channel, frame);
+    for (size_t k=0; k<n; k++, sp += view.stride())
+      sum += *sp;
+    frame += n;
+  }
+*/
+
+#ifndef DataView_h
+#define DataView_h
+
+
+#include <Arduino.h>
+#include <DataBuffer.h>
+
+
+class DataView {
+
+ public:
+
+  // Construct an empty view.
+  DataView();
+
+  // Set view to nframes frames of the first nchannels channels of
+  // the cyclic buffer holding nbuffer samples with stride channels
+  // multiplexed, beginning at sample index start.
+  void set(const volatile sample_t *buffer, size_t nbuffer, uint8_t stride,
+	   size_t start, uint8_t nchannels, size_t nframes);
+
+  // Number of channels accessible by this view.
+  uint8_t channels() const { return NChannels; };
+
+  // Number of frames of the view.
+  size_t frames() const { return NFrames; };
+
+  // Number of channels multiplexed in the buffer, i.e. distance
+  // between successive samples of a channel.
+  uint8_t stride() const { return Stride; };
+
+  // Index of the first sample of the view in the cyclic buffer.
+  size_t start() const { return Start; };
+
+  // Sample of channel at frame.
+  sample_t at(uint8_t channel, size_t frame) const {
+    size_t idx = Start + frame*Stride + channel;
+    if (idx >= NBuffer)
+      idx -= NBuffer;
+    return Buffer[idx];
+  };
+
+  // Pointer to the sample of channel at frame.
+  // The following samples of the channel are stride() samples apart,
+  // for contiguous(frame) frames.
+  const volatile sample_t *pointer(uint8_t channel, size_t frame) const;
+
+  // Number of frames starting at frame that are contiguous
+  // in memory, i.e. until the end of the view or the end of the
+  // cyclic buffer. Zero if frame straddles the end of the buffer.
+  size_t contiguous(size_t frame) const;
+
+  // Copy all frames of channel into buffer.
+  void getData(uint8_t channel, sample_t *buffer) const;
+
+  // Convert all frames of channel to float, multiply by scale
+  // and store them in buffer.
+  void getData(uint8_t channel, float *buffer, float scale) const;
+
+
+ protected:
+
+  const volatile sample_t *Buffer;
+  size_t NBuffer;
+  uint8_t Stride;
+  size_t Start;
+  uint8_t NChannels;
+  size_t NFrames;
+
+};
+
+
+#endif
@@ -229,12 +229,12 @@ size_t DataWorker::samples(float time) const {
 }
 
 
-float DataWorker::time(size_t samples) const {
+float DataWorker::time(uint64_t samples) const {
   return float(samples/nchannels())/rate();
 }
 
 
-void DataWorker::timeStr(size_t samples, char *str) const {
+void DataWorker::timeStr(uint64_t samples, char *str) const {
   float seconds = time(samples);
   float minutes = floor(seconds/60.0);
   seconds -= minutes*60;
@@ -108,12 +108,12 @@ public:
 
   // Time in seconds corresponding to a given number of samples
   // (not frames, i.e. samples is divided by the number of channels).
-  float time(size_t samples) const;
+  float time(uint64_t samples) const;
 
   // Return in str time corresponding to samples as a string displaying
   // minutes and seconds.
   // str must hold at least 6 characters.
-  void timeStr(size_t sample, char *str) const;
+  void timeStr(uint64_t sample, char *str) const;
 
   // Total time the buffer has been fed with samples in seconds.
   // Can be much larger than bufferTime().
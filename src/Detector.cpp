@@ -0,0 +1,24 @@
+#include <Detector.h>
+
+
+Detector::Detector() :
+  Channel(-1),
+  NChannels(1),
+  CChannel(0),
+  Rate(0),
+  Scale(sampleScale(16)) {
+}
+
+
+void Detector::setChannel(int channel) {
+  Channel = channel;
+}
+
+
+void Detector::start(uint8_t nchannels, float rate,
+		     uint8_t dataresolution) {
+  NChannels = nchannels > 0 ? nchannels : 1;
+  CChannel = 0;
+  Rate = rate;
+  Scale = sampleScale(dataresolution);
+}
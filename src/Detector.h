@@ -0,0 +1,60 @@
+/*
+  Detector - Base class for event detectors used by SDEventWriter.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+#ifndef Detector_h
+#define Detector_h
+
+
+#include <Arduino.h>
+#include <DataBuffer.h>
+
+
+class Detector {
+
+ public:
+
+  // Construct detector working on all channels.
+  Detector();
+
+  // Restrict detection to a single channel.
+  // Pass -1 for detecting events on any of the channels.
+  void setChannel(int channel);
+
+  // The channel on which events are detected, -1 for all channels.
+  int channel() const { return Channel; };
+
+  // Initialize detector for nchannels multiplexed channels sampled
+  // with rate Hertz and a resolution of dataresolution bits.
+  // Reimplement this function for initializing the state of a detector,
+  // but call this default implementation first.
+  virtual void start(uint8_t nchannels, float rate,
+		     uint8_t dataresolution=16);
+
+  // Analyze nsamples multiplexed samples of data that directly continue
+  // the samples passed to the previous call.
+  // Return the index into data of the first sample at which an event
+  // was detected, or -1 if no event was detected.
+  // All nsamples need to be processed, even if an event was detected.
+  virtual ssize_t detect(const volatile sample_t *data, size_t nsamples) = 0;
+
+
+ protected:
+
+  // True if current channel CChannel is to be analyzed.
+  bool selected() const { return (Channel < 0 || Channel == CChannel); };
+
+  // Advance current channel CChannel to the next sample.
+  void nextChannel() { if (++CChannel >= NChannels) CChannel = 0; };
+
+  int Channel;       // channel to be analyzed, -1 for all channels.
+  uint8_t NChannels; // number of multiplexed channels.
+  uint8_t CChannel;  // channel of the next sample.
+  float Rate;        // sampling rate per channel in Hertz.
+  float Scale;       // factor normalizing samples to the range -1 to 1.
+
+};
+
+
+#endif
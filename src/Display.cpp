@@ -15,6 +15,8 @@
 const uint16_t Display::PlotLines[8] = {GREEN, YELLOW, BLUE, RED, CYAN,
 					ORANGE, MAGENTA, WHITE};
 
+uint16_t Display::ColorMap[Display::NColors] = {0};
+
 
 Display::Display() {
   NPlots = 0;
@@ -39,7 +41,14 @@ Display::Display() {
     TextCanvas[k] = NULL;
     TextColor[k] = DefaultTextColor;
     TextBackground[k] = DefaultTextBackground;
+    for (int c=0; c<MaxTraces; c++)
+      Traces[k][c] = NULL;
+    SpecX[k] = 0;
+    SpecMin[k] = -100.0;
+    SpecMax[k] = 0.0;
   }
+  if (ColorMap[NColors-1] == 0)
+    initColorMap();
   memset(Text, 0, sizeof(Text));
   Font = NULL;
   TitleFont = NULL;
@@ -67,6 +76,7 @@ void Display::init(Adafruit_GFX *screen, uint8_t rotation, bool flip) {
 void Display::clear() {
   Screen->fillScreen(Background);
   for (int k=0; k<MaxAreas; k++) {
+    clearTraces(k);
     if (TextColorsSwapped[k])
       swapTextColors(k);
   }
@@ -85,6 +95,7 @@ void Display::setPlotArea(uint8_t area, float x0, float y0, float x1, float y1)
   PlotYOffs[area] = PlotY[area] + 0.5*PlotH[area];
   PlotYScale[area] = 0.5*PlotH[area];
   PlotYZoom[area] = 1.0;
+  clearTraces(area, true);
   NPlots = area + 1;
 }
 
@@ -109,6 +120,8 @@ void Display::clearPlot(uint8_t area) {
 		   PlotBackground);
   Screen->drawFastHLine(PlotX[area], dataY(area, int16_t(0)),
 			PlotW[area], PlotGrid);
+  clearTraces(area);
+  SpecX[area] = 0;
 }
 
 
@@ -209,6 +222,325 @@ void Display::plot(uint8_t area, const float *buffer, int nbuffer, int color) {
 }
 
 
+void Display::plot(uint8_t area, const int16_t *mins, const int16_t *maxs,
+		   int npixels, int color) {
+  if (PlotW[area] == 0 || npixels <= 0)
+    return;
+  color %= 8;
+  uint16_t pymin = 0xffff;
+  uint16_t pymax = 0xffff;
+  for (int k=0; k<npixels; k++) {
+    if (mins[k] > maxs[k]) {
+      pymin = 0xffff;
+      continue;
+    }
+    uint16_t x = dataX(area, k, npixels);
+    // larger values have smaller y-coordinates:
+    uint16_t ymin = dataY(area, maxs[k]);
+    uint16_t ymax = dataY(area, mins[k]);
+    uint16_t y0 = ymin;
+    uint16_t y1 = ymax;
+    // connect to previous column:
+    if (pymin < 0xffff) {
+      if (y0 > pymax)
+	y0 = pymax;
+      if (y1 < pymin)
+	y1 = pymin;
+    }
+    Screen->drawFastVLine(x, y0, y1-y0+1, PlotLines[color]);
+    pymin = ymin;
+    pymax = ymax;
+  }
+}
+
+
+void Display::updatePlot(uint8_t area, const int16_t *buffer, int nbuffer,
+			 int color) {
+  if (PlotW[area] == 0 || nbuffer <= 0)
+    return;
+  uint16_t top[PlotW[area]];
+  uint16_t bottom[PlotW[area]];
+  traceColumns(area, buffer, nbuffer, top, bottom);
+  updateTrace(area, color, top, bottom);
+}
+
+
+void Display::updatePlot(uint8_t area, const float *buffer, int nbuffer,
+			 int color) {
+  if (PlotW[area] == 0 || nbuffer <= 0)
+    return;
+  uint16_t top[PlotW[area]];
+  uint16_t bottom[PlotW[area]];
+  traceColumns(area, buffer, nbuffer, top, bottom);
+  updateTrace(area, color, top, bottom);
+}
+
+
+void Display::updatePlot(uint8_t area, const int16_t *mins,
+			 const int16_t *maxs, int npixels, int color) {
+  int w = PlotW[area];
+  if (w == 0 || npixels <= 0)
+    return;
+  uint16_t top[w];
+  uint16_t bottom[w];
+  for (int i=0; i<w; i++) {
+    int p0 = long(i)*npixels/w;
+    int p1 = long(i + 1)*npixels/w;
+    if (p1 <= p0)
+      p1 = p0 + 1;
+    top[i] = 0xffff;
+    bottom[i] = 0;
+    for (int p=p0; p<p1; p++) {
+      if (mins[p] > maxs[p])
+	continue;
+      // larger values have smaller y-coordinates:
+      uint16_t y0 = dataY(area, maxs[p]);
+      uint16_t y1 = dataY(area, mins[p]);
+      if (y0 < top[i])
+	top[i] = y0;
+      if (y1 > bottom[i])
+	bottom[i] = y1;
+    }
+  }
+  connectColumns(area, top, bottom);
+  updateTrace(area, color, top, bottom);
+}
+
+
+void Display::clearTraces(uint8_t area, bool release) {
+  for (int c=0; c<MaxTraces; c++) {
+    uint16_t *trace = Traces[area][c];
+    if (trace == NULL)
+      continue;
+    if (release) {
+      free(trace);
+      Traces[area][c] = NULL;
+    }
+    else {
+      for (int i=0; i<PlotW[area]; i++) {
+	trace[i] = 0xffff;
+	trace[PlotW[area] + i] = 0;
+      }
+    }
+  }
+}
+
+
+template <typename T>
+void Display::traceColumns(uint8_t area, const T *buffer, int nbuffer,
+			   uint16_t *top, uint16_t *bottom) {
+  int w = PlotW[area];
+  for (int i=0; i<w; i++) {
+    top[i] = 0xffff;
+    bottom[i] = 0;
+  }
+  if (nbuffer < 2*w) {
+    // columns covered by straight lines between the data points:
+    int x0 = dataX(area, 0, nbuffer) - PlotX[area];
+    int y0 = dataY(area, buffer[0]);
+    top[x0] = y0;
+    bottom[x0] = y0;
+    for (int k=1; k<nbuffer; k++) {
+      int x1 = dataX(area, k, nbuffer) - PlotX[area];
+      int y1 = dataY(area, buffer[k]);
+      for (int x=x0; x<=x1 && x<w; x++) {
+	int ya = y0;
+	int yb = y1;
+	if (x1 > x0) {
+	  ya = y0 + (y1 - y0)*(x - x0)/(x1 - x0);
+	  yb = x < x1 ? y0 + (y1 - y0)*(x + 1 - x0)/(x1 - x0) : y1;
+	}
+	if (ya > yb) {
+	  int y = ya;
+	  ya = yb;
+	  yb = y;
+	}
+	if (ya < top[x])
+	  top[x] = ya;
+	if (yb > bottom[x])
+	  bottom[x] = yb;
+      }
+      x0 = x1;
+      y0 = y1;
+    }
+  }
+  else {
+    for (int k=0; k<nbuffer; k++) {
+      int x = long(k)*w/nbuffer;
+      uint16_t y = dataY(area, buffer[k]);
+      if (y < top[x])
+	top[x] = y;
+      if (y > bottom[x])
+	bottom[x] = y;
+    }
+    connectColumns(area, top, bottom);
+  }
+}
+
+
+void Display::connectColumns(uint8_t area, uint16_t *top, uint16_t *bottom) {
+  uint16_t ptop = 0xffff;
+  uint16_t pbottom = 0;
+  for (int i=0; i<PlotW[area]; i++) {
+    uint16_t t = top[i];
+    uint16_t b = bottom[i];
+    if (t > b) {
+      ptop = 0xffff;
+      pbottom = 0;
+      continue;
+    }
+    if (ptop <= pbottom) {
+      if (top[i] > pbottom)
+	top[i] = pbottom;
+      if (bottom[i] < ptop)
+	bottom[i] = ptop;
+    }
+    ptop = t;
+    pbottom = b;
+  }
+}
+
+
+void Display::updateTrace(uint8_t area, int color,
+			  const uint16_t *top, const uint16_t *bottom) {
+  color %= MaxTraces;
+  int w = PlotW[area];
+  if (Traces[area][color] == NULL) {
+    Traces[area][color] = (uint16_t *)malloc(2*w*sizeof(uint16_t));
+    if (Traces[area][color] == NULL) {
+      Serial.println("ERROR in Display::updatePlot(): not enough memory for storing trace.");
+      return;
+    }
+    for (int i=0; i<w; i++) {
+      Traces[area][color][i] = 0xffff;
+      Traces[area][color][w + i] = 0;
+    }
+  }
+  uint16_t *ptop = Traces[area][color];
+  uint16_t *pbottom = ptop + w;
+  // a single write transaction for all changed columns:
+  Screen->startWrite();
+  for (int i=0; i<w; i++) {
+    if (top[i] == ptop[i] && bottom[i] == pbottom[i])
+      continue;
+    int16_t x = PlotX[area] + i;
+    int t = top[i];
+    int b = bottom[i];
+    int pt = ptop[i];
+    int pb = pbottom[i];
+    if (t > b)
+      eraseColumn(area, color, i, pt, pb);
+    else if (pt > pb)
+      Screen->writeFastVLine(x, t, b-t+1, PlotLines[color]);
+    else {
+      // erase previous pixels not covered by the new column:
+      eraseColumn(area, color, i, pt, pb < t ? pb : t - 1);
+      eraseColumn(area, color, i, pt > b ? pt : b + 1, pb);
+      // draw new pixels not covered by the previous column:
+      int y1 = b < pt ? b : pt - 1;
+      if (y1 >= t)
+	Screen->writeFastVLine(x, t, y1-t+1, PlotLines[color]);
+      int y0 = t > pb ? t : pb + 1;
+      if (b >= y0)
+	Screen->writeFastVLine(x, y0, b-y0+1, PlotLines[color]);
+    }
+    ptop[i] = top[i];
+    pbottom[i] = bottom[i];
+  }
+  Screen->endWrite();
+}
+
+
+void Display::eraseColumn(uint8_t area, int color, int column,
+			  int y0, int y1) {
+  if (y1 < y0)
+    return;
+  int16_t x = PlotX[area] + column;
+  Screen->writeFastVLine(x, y0, y1-y0+1, PlotBackground);
+  int grid = dataY(area, int16_t(0));
+  if (grid >= y0 && grid <= y1)
+    Screen->writeFastVLine(x, grid, 1, PlotGrid);
+  for (int c=0; c<MaxTraces; c++) {
+    if (c == color || Traces[area][c] == NULL)
+      continue;
+    int t = Traces[area][c][column];
+    int b = Traces[area][c][PlotW[area] + column];
+    if (t < y0)
+      t = y0;
+    if (b > y1)
+      b = y1;
+    if (t <= b)
+      Screen->writeFastVLine(x, t, b-t+1, PlotLines[c]);
+  }
+}
+
+
+void Display::setSpectrumRange(uint8_t area, float dbmin, float dbmax) {
+  if (dbmax <= dbmin)
+    dbmax = dbmin + 1.0;
+  SpecMin[area] = dbmin;
+  SpecMax[area] = dbmax;
+}
+
+
+void Display::plotSpectrum(uint8_t area, const float *power, size_t nfreqs) {
+  int h = PlotH[area];
+  if (PlotW[area] == 0 || h == 0 || nfreqs == 0)
+    return;
+  if (SpecX[area] >= PlotW[area])
+    SpecX[area] = 0;
+  int16_t x = PlotX[area] + SpecX[area];
+  // color index of each row, lowest frequency at the bottom:
+  uint8_t levels[h];
+  float scale = NColors/(SpecMax[area] - SpecMin[area]);
+  for (int r=0; r<h; r++) {
+    size_t k0 = size_t(r)*nfreqs/h;
+    size_t k1 = size_t(r + 1)*nfreqs/h;
+    if (k1 <= k0)
+      k1 = k0 + 1;
+    // maximum power of all frequencies of a row:
+    float p = power[k0];
+    for (size_t k=k0+1; k<k1; k++) {
+      if (power[k] > p)
+	p = power[k];
+    }
+    float c = p > 1e-20 ? (10.0*log10f(p) - SpecMin[area])*scale : 0;
+    levels[h - 1 - r] = c < 0 ? 0 : (c >= NColors ? NColors - 1 : uint8_t(c));
+  }
+  // draw runs of equal colors as vertical lines in a single transaction:
+  Screen->startWrite();
+  int r0 = 0;
+  for (int r=1; r<=h; r++) {
+    if (r == h || levels[r] != levels[r0]) {
+      Screen->writeFastVLine(x, PlotY[area] + r0, r - r0,
+			     ColorMap[levels[r0]]);
+      r0 = r;
+    }
+  }
+  // clear the oldest column:
+  SpecX[area]++;
+  int xn = SpecX[area] < PlotW[area] ? x + 1 : PlotX[area];
+  Screen->writeFastVLine(xn, PlotY[area], h, PlotBackground);
+  Screen->endWrite();
+}
+
+
+void Display::initColorMap() {
+  // dark blue, purple, red, orange, light yellow:
+  const uint8_t anchors[5][3] = {{0, 0, 16}, {90, 16, 110}, {190, 55, 80},
+				 {250, 140, 10}, {252, 255, 165}};
+  for (int k=0; k<NColors; k++) {
+    float x = 4.0*k/(NColors - 1);
+    int i = x >= 4.0 ? 3 : int(x);
+    float f = x - i;
+    uint8_t rgb[3];
+    for (int c=0; c<3; c++)
+      rgb[c] = anchors[i][c] + f*(anchors[i + 1][c] - anchors[i][c]);
+    ColorMap[k] = ((rgb[0] & 0xf8) << 8) | ((rgb[1] & 0xfc) << 3) | (rgb[2] >> 3);
+  }
+}
+
+
 uint16_t Display::dataX(uint8_t area, float x, float maxx) {
   return PlotX[area] + uint16_t(x/maxx*PlotW[area]);
 }
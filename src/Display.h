@@ -190,6 +190,45 @@ class Display {
   // color (index into PlotLines).
   void plot(uint8_t area, const float *buffer, int nbuffer, int color=0);
 
+  // Plot minimum and maximum values of npixels columns in plot area
+  // with some color (index into PlotLines), for example as returned
+  // by MinMaxPyramid::getMinMax().
+  // Columns with a minimum larger than the maximum are skipped.
+  void plot(uint8_t area, const int16_t *mins, const int16_t *maxs,
+	    int npixels, int color=0);
+
+  // Update data trace from buffer in plot area with some color
+  // (index into PlotLines). Only pixel columns that differ from the
+  // previous trace of this color in this area are erased and redrawn.
+  // Use this instead of clearPlot() and plot() for continuously
+  // refreshed traces. Call clearPlot() once before the first update.
+  void updatePlot(uint8_t area, const int16_t *buffer, int nbuffer,
+		  int color=0);
+
+  // Update data trace from buffer (-1 to 1) in plot area with some
+  // color (index into PlotLines), see above.
+  void updatePlot(uint8_t area, const float *buffer, int nbuffer,
+		  int color=0);
+
+  // Update data trace from minimum and maximum values of npixels
+  // columns in plot area with some color (index into PlotLines),
+  // for example as returned by MinMaxPyramid::getMinMax(), see above.
+  void updatePlot(uint8_t area, const int16_t *mins, const int16_t *maxs,
+		  int npixels, int color=0);
+
+  // Set range of power levels in decibel that is mapped onto the
+  // colormap of spectrograms in plot area (default -100 to 0dB).
+  void setSpectrumRange(uint8_t area, float dbmin, float dbmax);
+
+  // Plot the nfreqs values of a power spectrum, for example from
+  // SpectrumAnalyzer::spectrum(), as the next column of a spectrogram
+  // in plot area. Frequency increases upwards.
+  // The columns sweep from left to right and wrap around, such that
+  // only a single column is drawn and the rest of the area never
+  // needs to be redrawn. The column right of the current one is
+  // cleared to mark the sweep position.
+  void plotSpectrum(uint8_t area, const float *power, size_t nfreqs);
+
   // Set amplitude zoom factor of plot area to fac.
   void setPlotZoom(uint8_t area, float fac);
 
@@ -310,6 +349,43 @@ class Display {
   float PlotYScale[MaxAreas];
   float PlotYZoom[MaxAreas];
 
+  // Previous traces drawn by updatePlot(), top and bottom
+  // y-coordinates of each column of a plot area for each color:
+  static const uint8_t MaxTraces = 8;
+  uint16_t *Traces[MaxAreas][MaxTraces];
+
+  // Mark previous traces of plot area as erased.
+  // If release, free their memory.
+  void clearTraces(uint8_t area, bool release=false);
+
+  // Top and bottom y-coordinates of each column of plot area for
+  // the data in buffer.
+  template <typename T>
+  void traceColumns(uint8_t area, const T *buffer, int nbuffer,
+		    uint16_t *top, uint16_t *bottom);
+
+  // Extend columns to connect them with their left neighbors.
+  void connectColumns(uint8_t area, uint16_t *top, uint16_t *bottom);
+
+  // Erase and draw only the differences between the new trace given
+  // by top and bottom and the previous one of color.
+  void updateTrace(uint8_t area, int color,
+		   const uint16_t *top, const uint16_t *bottom);
+
+  // Erase pixels y0 to y1 of column of plot area and restore the
+  // grid and all other traces.
+  void eraseColumn(uint8_t area, int color, int column, int y0, int y1);
+
+  // Spectrograms:
+  static const int NColors = 256;
+  static uint16_t ColorMap[NColors]; // RGB565 colors for power levels.
+  int16_t SpecX[MaxAreas];           // column of the next spectrum.
+  float SpecMin[MaxAreas];           // power in decibel of lowest color.
+  float SpecMax[MaxAreas];           // power in decibel of highest color.
+
+  // Precompute colormap lookup table.
+  static void initColorMap();
+
   // Translate x value to x-coordinate.
   uint16_t dataX(uint8_t area, float x, float maxx);
   // Translate y value (between -1 and 1) to y-coordinate.
@@ -0,0 +1,263 @@
+#include <LevelAnalyzer.h>
+
+
+#if defined(__ARM_FEATURE_DSP)
+
+// Signed 16-bit SIMD maximum of each half-word of a and b.
+static inline uint32_t max16x2(uint32_t a, uint32_t b) {
+  uint32_t r;
+  asm volatile("ssub16 %0, %1, %2\n\tsel %0, %1, %2"
+	       : "=&r" (r) : "r" (a), "r" (b) : "cc");
+  return r;
+}
+
+// Signed 16-bit SIMD minimum of each half-word of a and b.
+static inline uint32_t min16x2(uint32_t a, uint32_t b) {
+  uint32_t r;
+  asm volatile("ssub16 %0, %1, %2\n\tsel %0, %2, %1"
+	       : "=&r" (r) : "r" (a), "r" (b) : "cc");
+  return r;
+}
+
+// 0x0001 in each half-word where a >= b, 0 otherwise.
+static inline uint32_t ge16x2(uint32_t a, uint32_t b) {
+  uint32_t r;
+  asm volatile("ssub16 %0, %1, %2\n\tsel %0, %3, %4"
+	       : "=&r" (r) : "r" (a), "r" (b), "r" (0x00010001), "r" (0)
+	       : "cc");
+  return r;
+}
+
+// Unsigned 16-bit SIMD addition of each half-word of a and b.
+static inline uint32_t add16x2(uint32_t a, uint32_t b) {
+  uint32_t r;
+  asm volatile("uadd16 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b) : "cc");
+  return r;
+}
+
+// Add product of lower half-words of a and b to acc.
+static inline int64_t mac16b(int64_t acc, uint32_t a, uint32_t b) {
+  asm volatile("smlald %Q0, %R0, %1, %2"
+	       : "+r" (acc) : "r" (a), "r" (b & 0x0000ffff));
+  return acc;
+}
+
+// Add product of upper half-words of a and b to acc.
+static inline int64_t mac16t(int64_t acc, uint32_t a, uint32_t b) {
+  asm volatile("smlald %Q0, %R0, %1, %2"
+	       : "+r" (acc) : "r" (a), "r" (b & 0xffff0000));
+  return acc;
+}
+
+#endif
+
+
+LevelAnalyzer::LevelAnalyzer(AnalysisChain *chain) :
+  Analyzer(chain),
+  ClipLevel(0.99),
+  NChannels(0),
+  ClipHigh(32767),
+  ClipLow(-32768),
+  Active(0) {
+  ReadOnly = true;
+  memset(Slots, 0, sizeof(Slots));
+}
+
+
+void LevelAnalyzer::setClipLevel(float level) {
+  if (level > 1.0)
+    level = 1.0;
+  if (level < 0.0)
+    level = 0.0;
+  ClipLevel = level;
+}
+
+
+uint32_t LevelAnalyzer::counter() const {
+  return Slots[Active].counter;
+}
+
+
+bool LevelAnalyzer::levels(Levels &levels) const {
+  const Levels &slot = Slots[Active];
+  if (slot.counter == 0)
+    return false;
+  levels = slot;
+  return true;
+}
+
+
+float LevelAnalyzer::rms(uint8_t channel) const {
+  const Levels &slot = Slots[Active];
+  if (channel >= slot.nchannels)
+    return 0.0;
+  return slot.rms[channel];
+}
+
+
+float LevelAnalyzer::peak(uint8_t channel) const {
+  const Levels &slot = Slots[Active];
+  if (channel >= slot.nchannels)
+    return 0.0;
+  return slot.peak[channel];
+}
+
+
+uint32_t LevelAnalyzer::clipped(uint8_t channel) const {
+  const Levels &slot = Slots[Active];
+  if (channel >= slot.nchannels)
+    return 0;
+  return slot.clipped[channel];
+}
+
+
+float LevelAnalyzer::maxPeak() const {
+  const Levels &slot = Slots[Active];
+  float max = 0.0;
+  for (uint8_t c=0; c<slot.nchannels; c++) {
+    if (slot.peak[c] > max)
+      max = slot.peak[c];
+  }
+  return max;
+}
+
+
+void LevelAnalyzer::report(Stream &stream) const {
+  Levels levels;
+  if (!this->levels(levels)) {
+    stream.println("No levels available.");
+    return;
+  }
+  stream.printf("Levels of window %lu:\n", levels.counter);
+  for (uint8_t c=0; c<levels.nchannels; c++)
+    stream.printf("  channel %2u: RMS %5.1f%%, peak %5.1f%%, %lu clipped\n",
+		  c, 100.0*levels.rms[c], 100.0*levels.peak[c],
+		  levels.clipped[c]);
+}
+
+
+void LevelAnalyzer::start(uint8_t nchannels, size_t nframes) {
+  NChannels = nchannels;
+  if (NChannels > MaxChannels) {
+    Serial.printf("WARNING in LevelAnalyzer::start(): analyze only the first %u of %u channels.\n", MaxChannels, nchannels);
+    NChannels = MaxChannels;
+  }
+  // full range of the data:
+  int32_t range = int32_t(1.0/Scale + 0.5);
+  int32_t clip = ClipLevel*range;
+  ClipHigh = clip > range - 1 ? range - 1 : clip;
+  ClipLow = -clip;
+}
+
+
+void LevelAnalyzer::analyze(const DataView &data) {
+  uint8_t nchannels = NChannels < data.channels() ? NChannels : data.channels();
+  if (nchannels == 0 || data.frames() == 0)
+    return;
+  for (uint8_t c=0; c<nchannels; c++) {
+    SumSq[c] = 0;
+    // only needed for the peak, the largest absolute value:
+    Min[c] = 0;
+    Max[c] = 0;
+    Clipped[c] = 0;
+  }
+  size_t frame = 0;
+  while (frame < data.frames()) {
+    size_t n = data.contiguous(frame);
+    if (n == 0) {
+      // frame straddles the end of the buffer:
+      sample_t samples[MaxChannels];
+      for (uint8_t c=0; c<nchannels; c++)
+	samples[c] = data.at(c, frame);
+      accumulate(samples, 1, nchannels);
+      frame++;
+      continue;
+    }
+    const volatile sample_t *buffer = data.pointer(0, frame);
+#if defined(__ARM_FEATURE_DSP)
+    if (nchannels%2 == 0 && data.stride()%2 == 0 &&
+	((uintptr_t)buffer & 0x03) == 0)
+      accumulatePairs(buffer, n, data.stride());
+    else
+#endif
+      accumulate(buffer, n, data.stride());
+    frame += n;
+  }
+  // publish in inactive slot:
+  uint8_t inactive = 1 - Active;
+  Levels &slot = Slots[inactive];
+  slot.counter = Slots[Active].counter + 1;
+  slot.nchannels = nchannels;
+  for (uint8_t c=0; c<nchannels; c++) {
+    slot.rms[c] = sqrt(float(SumSq[c])/data.frames())*Scale;
+    int32_t peak = -int32_t(Min[c]) > Max[c] ? -int32_t(Min[c]) : Max[c];
+    slot.peak[c] = peak*Scale;
+    slot.clipped[c] = Clipped[c];
+  }
+  Active = inactive;
+}
+
+
+void LevelAnalyzer::accumulate(const volatile sample_t *buffer,
+			       size_t nframes, uint8_t stride) {
+  uint8_t nchannels = NChannels < stride ? NChannels : stride;
+  for (size_t k=0; k<nframes; k++) {
+    for (uint8_t c=0; c<nchannels; c++) {
+      int32_t x = buffer[c];
+      SumSq[c] += x*x;
+      if (x < Min[c])
+	Min[c] = x;
+      if (x > Max[c])
+	Max[c] = x;
+      if (x >= ClipHigh || x <= ClipLow)
+	Clipped[c]++;
+    }
+    buffer += stride;
+  }
+}
+
+
+void LevelAnalyzer::accumulatePairs(const volatile sample_t *buffer,
+				    size_t nframes, uint8_t stride) {
+#if defined(__ARM_FEATURE_DSP)
+  uint8_t npairs = (NChannels < stride ? NChannels : stride)/2;
+  uint32_t high = ((uint16_t)ClipHigh << 16) | (uint16_t)ClipHigh;
+  uint32_t low = ((uint16_t)ClipLow << 16) | (uint16_t)ClipLow;
+  for (uint8_t p=0; p<npairs; p++) {
+    const volatile uint32_t *wp = (const volatile uint32_t *)buffer + p;
+    size_t wstride = stride/2;
+    uint8_t c = 2*p;
+    int64_t sumsq0 = SumSq[c];
+    int64_t sumsq1 = SumSq[c + 1];
+    uint32_t min = ((uint16_t)Min[c + 1] << 16) | (uint16_t)Min[c];
+    uint32_t max = ((uint16_t)Max[c + 1] << 16) | (uint16_t)Max[c];
+    size_t k = 0;
+    while (k < nframes) {
+      // 16-bit clipping counters need to be flushed regularly:
+      size_t n = nframes - k;
+      if (n > 0x7fff)
+	n = 0x7fff;
+      uint32_t clipped = 0;
+      for (size_t i=0; i<n; i++) {
+	uint32_t w = *wp;
+	sumsq0 = mac16b(sumsq0, w, w);
+	sumsq1 = mac16t(sumsq1, w, w);
+	min = min16x2(w, min);
+	max = max16x2(w, max);
+	clipped = add16x2(clipped, ge16x2(w, high));
+	clipped = add16x2(clipped, ge16x2(low, w));
+	wp += wstride;
+      }
+      Clipped[c] += clipped & 0xffff;
+      Clipped[c + 1] += clipped >> 16;
+      k += n;
+    }
+    SumSq[c] = sumsq0;
+    SumSq[c + 1] = sumsq1;
+    Min[c] = (int16_t)(min & 0xffff);
+    Min[c + 1] = (int16_t)(min >> 16);
+    Max[c] = (int16_t)(max & 0xffff);
+    Max[c + 1] = (int16_t)(max >> 16);
+  }
+#endif
+}
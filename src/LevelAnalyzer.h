@@ -0,0 +1,115 @@
+/*
+  LevelAnalyzer - RMS, peak, and clipping of all channels.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+/*
+  The levels of all channels are computed directly on the multiplexed
+  data in the cyclic buffer, sum of squares, minimum, maximum and
+  clipping in a single pass. On processors with DSP extension
+  (Teensy 3.x, 4.x) pairs of channels are processed at once with
+  16-bit SIMD instructions.
+
+  The results of the most recent analysis window are published as a
+  Levels snapshot in one of two slots. The active slot is switched
+  after the other one has been completely written. Reading the levels
+  from loop() or from an interrupt service routine (e.g. for audio
+  feedback) is therefore safe without locking.
+*/
+
+#ifndef LevelAnalyzer_h
+#define LevelAnalyzer_h
+
+
+#include <Analyzer.h>
+
+
+class LevelAnalyzer : public Analyzer {
+
+ public:
+
+  static const uint8_t MaxChannels = 32;
+
+  // Levels of all channels of a single analysis window.
+  // RMS and peak values are relative to the full range of the data
+  // (between 0 and 1).
+  struct Levels {
+    uint32_t counter;             // number of the analysis window
+    uint8_t nchannels;            // number of analyzed channels
+    float rms[MaxChannels];       // root-mean-square of each channel
+    float peak[MaxChannels];      // maximum absolute value of each channel
+    uint32_t clipped[MaxChannels]; // number of clipped samples of each channel
+  };
+
+  // Construct level analyzer and add it to an AnalysisChain.
+  LevelAnalyzer(AnalysisChain *chain=0);
+
+  // Level relative to full range above which samples are counted as clipped.
+  float clipLevel() const { return ClipLevel; };
+
+  // Set level relative to full range (between 0 and 1) above which
+  // samples are counted as clipped. Default is 0.99.
+  void setClipLevel(float level);
+
+  // Number of analysis windows analyzed so far.
+  // Use this for checking whether there are new levels.
+  uint32_t counter() const;
+
+  // Copy the levels of the most recent analysis window into levels.
+  // Return false if no levels are available yet.
+  bool levels(Levels &levels) const;
+
+  // RMS of channel of the most recent analysis window.
+  float rms(uint8_t channel) const;
+
+  // Peak value of channel of the most recent analysis window.
+  float peak(uint8_t channel) const;
+
+  // Number of clipped samples of channel of the most recent analysis window.
+  uint32_t clipped(uint8_t channel) const;
+
+  // Maximum peak value over all channels of the most recent analysis window.
+  // Use this, for example, for AudioMonitor::setFeedback().
+  float maxPeak() const;
+
+  // Report levels of all channels on stream.
+  void report(Stream &stream=Serial) const;
+
+  // Initialize levels.
+  virtual void start(uint8_t nchannels, size_t nframes);
+
+  // Compute levels of all channels of data.
+  virtual void analyze(const DataView &data);
+
+
+ protected:
+
+  // Accumulate nframes of nchannels channels of multiplexed data
+  // starting at buffer with stride samples between frames.
+  void accumulate(const volatile sample_t *buffer, size_t nframes,
+		  uint8_t stride);
+
+  // Same as accumulate() for an even number of channels with pairs
+  // of channels processed at once.
+  void accumulatePairs(const volatile sample_t *buffer, size_t nframes,
+		       uint8_t stride);
+
+  float ClipLevel;
+  uint8_t NChannels;
+
+  // Accumulators of current window:
+  int64_t SumSq[MaxChannels];
+  int16_t Min[MaxChannels];
+  int16_t Max[MaxChannels];
+  uint32_t Clipped[MaxChannels];
+  int16_t ClipHigh;
+  int16_t ClipLow;
+
+  // Published levels:
+  Levels Slots[2];
+  volatile uint8_t Active;
+
+};
+
+
+#endif
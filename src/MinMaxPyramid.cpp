@@ -0,0 +1,222 @@
+#include <DataBuffer.h>
+#include <MinMaxPyramid.h>
+
+
+MinMaxPyramid::MinMaxPyramid(const DataWorker &producer, size_t nbins,
+			     uint8_t nlevels, uint8_t decimation,
+			     int verbose) :
+  DataWorker(&producer, verbose),
+  NBins(nbins),
+  NLevels(nlevels),
+  Decimation(decimation),
+  NChannels(0),
+  Memory(0),
+  BinFill(0) {
+  if (NLevels < 1)
+    NLevels = 1;
+  if (NLevels > MaxLevels)
+    NLevels = MaxLevels;
+  if (Decimation < 2)
+    Decimation = 2;
+  if (NBins < Decimation)
+    NBins = Decimation;
+  for (uint8_t l=0; l<MaxLevels; l++) {
+    Head[l] = 0;
+    Filled[l] = 0;
+    Count[l] = 0;
+  }
+}
+
+
+MinMaxPyramid::~MinMaxPyramid() {
+  stop();
+}
+
+
+size_t MinMaxPyramid::binFrames(uint8_t level) const {
+  size_t n = Decimation;
+  for (uint8_t l=0; l<level; l++)
+    n *= Decimation;
+  return n;
+}
+
+
+size_t MinMaxPyramid::maxFrames() const {
+  return NBins*binFrames(NLevels - 1);
+}
+
+
+bool MinMaxPyramid::start() {
+  stop();
+  if (Producer == 0 || nchannels() == 0) {
+    Serial.println("ERROR in MinMaxPyramid::start(): no data available.");
+    return false;
+  }
+  NChannels = nchannels();
+  size_t n = 2*NLevels*NChannels*NBins;
+  Memory = (int16_t *)malloc(n*sizeof(int16_t));
+  if (Memory == 0) {
+    Serial.printf("ERROR in MinMaxPyramid::start(): not enough memory for %u bins.\n", n);
+    NChannels = 0;
+    return false;
+  }
+  for (uint8_t l=0; l<MaxLevels; l++) {
+    Head[l] = 0;
+    Filled[l] = 0;
+    Count[l] = 0;
+  }
+  BinFill = 0;
+  synchronize();
+  return true;
+}
+
+
+void MinMaxPyramid::stop() {
+  if (Memory != 0)
+    free(Memory);
+  Memory = 0;
+  NChannels = 0;
+}
+
+
+void MinMaxPyramid::reset() {
+  for (uint8_t l=0; l<MaxLevels; l++) {
+    Head[l] = 0;
+    Filled[l] = 0;
+    Count[l] = 0;
+  }
+  BinFill = 0;
+  DataWorker::reset();
+}
+
+
+void MinMaxPyramid::update() {
+  if (Memory == 0)
+    return;
+  if (nchannels() != NChannels) {
+    Serial.println("ERROR in MinMaxPyramid::update(): number of channels changed. Call start() again.");
+    stop();
+    return;
+  }
+  size_t missed = overrun();
+  if (missed > 0 && Verbose > 0)
+    Serial.printf("WARNING in MinMaxPyramid::update(): data overrun, missed %u frames.\n", missed/NChannels);
+  size_t navail = available()/NChannels;
+  while (navail > 0) {
+    // frames up to the end of the current bin and of the data buffer:
+    size_t n = Decimation - BinFill;
+    size_t ncont = (nbuffer() - Index)/NChannels;
+    if (n > ncont)
+      n = ncont;
+    if (n > navail)
+      n = navail;
+    const volatile sample_t *buffer = &Data->buffer()[Index];
+    size_t head = Head[0];
+    for (uint8_t c=0; c<NChannels; c++) {
+      int16_t *mn = mins(0, c);
+      int16_t *mx = maxs(0, c);
+      int16_t min = BinFill == 0 ? 32767 : mn[head];
+      int16_t max = BinFill == 0 ? -32768 : mx[head];
+      const volatile sample_t *bp = buffer + c;
+      for (size_t k=0; k<n; k++) {
+	int16_t x = *bp;
+	if (x < min)
+	  min = x;
+	if (x > max)
+	  max = x;
+	bp += NChannels;
+      }
+      mn[head] = min;
+      mx[head] = max;
+    }
+    increment(n*NChannels);
+    navail -= n;
+    BinFill += n;
+    if (BinFill >= Decimation) {
+      BinFill = 0;
+      completeBin(0);
+    }
+  }
+}
+
+
+void MinMaxPyramid::completeBin(uint8_t level) {
+  size_t head = Head[level];
+  if (++Head[level] >= NBins)
+    Head[level] = 0;
+  if (Filled[level] < NBins)
+    Filled[level]++;
+  if (level + 1 >= NLevels)
+    return;
+  if (++Count[level] < Decimation)
+    return;
+  Count[level] = 0;
+  // summarize the last Decimation bins in the next level:
+  size_t start = (head + NBins + 1 - Decimation) % NBins;
+  size_t next = Head[level + 1];
+  for (uint8_t c=0; c<NChannels; c++) {
+    const int16_t *mn = mins(level, c);
+    const int16_t *mx = maxs(level, c);
+    int16_t min = 32767;
+    int16_t max = -32768;
+    size_t i = start;
+    for (uint8_t k=0; k<Decimation; k++) {
+      if (mn[i] < min)
+	min = mn[i];
+      if (mx[i] > max)
+	max = mx[i];
+      if (++i >= NBins)
+	i = 0;
+    }
+    mins(level + 1, c)[next] = min;
+    maxs(level + 1, c)[next] = max;
+  }
+  completeBin(level + 1);
+}
+
+
+int MinMaxPyramid::getMinMax(uint8_t channel, size_t nframes,
+			     int16_t *mins, int16_t *maxs,
+			     size_t npixels) const {
+  if (Memory == 0 || channel >= NChannels || npixels == 0)
+    return -1;
+  // coarsest level with at least one bin per pixel:
+  uint8_t level = 0;
+  while (level + 1 < NLevels && binFrames(level + 1)*npixels <= nframes)
+    level++;
+  // finer levels might not cover nframes:
+  while (level + 1 < NLevels && binFrames(level)*NBins < nframes)
+    level++;
+  size_t bf = binFrames(level);
+  size_t nb = (nframes + bf/2)/bf;
+  if (nb == 0)
+    nb = 1;
+  if (nb > NBins)
+    nb = NBins;
+  const int16_t *mn = this->mins(level, channel);
+  const int16_t *mx = this->maxs(level, channel);
+  size_t head = Head[level];
+  size_t filled = Filled[level];
+  for (size_t p=0; p<npixels; p++) {
+    size_t b0 = p*nb/npixels;
+    size_t b1 = (p + 1)*nb/npixels;
+    if (b1 <= b0)
+      b1 = b0 + 1;
+    int16_t min = 32767;
+    int16_t max = -32768;
+    for (size_t b=b0; b<b1; b++) {
+      // age of bin, 1 is the most recently completed one:
+      size_t age = nb - b;
+      if (age > filled)
+	continue;
+      size_t i = (head + NBins - age) % NBins;
+      if (mn[i] < min)
+	min = mn[i];
+      if (mx[i] > max)
+	max = mx[i];
+    }
+    mins[p] = min;
+    maxs[p] = max;
+  }
+  return level;
+}
@@ -0,0 +1,117 @@
+/*
+  MinMaxPyramid - Multi-level minima and maxima of all channels for fast plotting.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+/*
+  The data of each channel are summarized in bins of a few frames
+  holding the minimum and maximum value of the bin. Each level of the
+  pyramid decimates the bins of the level below by a constant factor.
+  update() consumes newly acquired data and updates all levels
+  incrementally, so the work per frame is constant.
+
+  getMinMax() fills minima and maxima of pixel columns for the most
+  recent data from the coarsest level that still has at least one bin
+  per pixel. The costs of plotting a trace are then proportional to
+  the number of pixels and not to the number of data frames.
+
+  Usage:
+
+  MinMaxPyramid pyramid(aidata);
+  pyramid.start();
+  ...
+  void loop() {
+    pyramid.update();
+    ...
+    int16_t mins[npixels];
+    int16_t maxs[npixels];
+    pyramid.getMinMax(channel, aidata.frames(2.0), mins, maxs, npixels);
+    screen.plot(area, mins, maxs, npixels);
+  }
+*/
+
+#ifndef MinMaxPyramid_h
+#define MinMaxPyramid_h
+
+
+#include <Arduino.h>
+#include <DataWorker.h>
+
+
+class MinMaxPyramid : public DataWorker {
+
+ public:
+
+  static const uint8_t MaxLevels = 8;
+
+  // Construct pyramid consuming data of producer with nlevels levels
+  // of nbins bins each. The bins of the lowest level summarize
+  // decimation frames, and each level decimates the one below by
+  // decimation.
+  MinMaxPyramid(const DataWorker &producer, size_t nbins=256,
+		uint8_t nlevels=5, uint8_t decimation=4, int verbose=0);
+  ~MinMaxPyramid();
+
+  // Number of levels.
+  uint8_t levels() const { return NLevels; };
+
+  // Number of bins of each level.
+  size_t bins() const { return NBins; };
+
+  // Number of frames summarized by a single bin of level.
+  size_t binFrames(uint8_t level) const;
+
+  // Maximum number of frames covered by the pyramid.
+  size_t maxFrames() const;
+
+  // Allocate the pyramid for all channels of the producer and start
+  // consuming data from the current position of the producer.
+  // Return false if not enough memory is available.
+  bool start();
+
+  // Stop consuming data and free memory.
+  void stop();
+
+  // Clear the pyramid.
+  virtual void reset();
+
+  // Consume all newly available data. Call this regularly in loop().
+  void update();
+
+  // Fill mins and maxs with minimum and maximum values of channel
+  // for npixels columns spanning the most recent nframes frames.
+  // Columns for which no data are available yet get a minimum larger
+  // than the maximum.
+  // Return the level used or -1 if the pyramid has not been started.
+  int getMinMax(uint8_t channel, size_t nframes,
+		int16_t *mins, int16_t *maxs, size_t npixels) const;
+
+
+ protected:
+
+  // Minima of channel on level.
+  int16_t *mins(uint8_t level, uint8_t channel) const
+    { return &Memory[(2*(level*NChannels + channel))*NBins]; };
+
+  // Maxima of channel on level.
+  int16_t *maxs(uint8_t level, uint8_t channel) const
+    { return &Memory[(2*(level*NChannels + channel) + 1)*NBins]; };
+
+  // Complete current bin of level and propagate it to the levels above.
+  void completeBin(uint8_t level);
+
+  size_t NBins;
+  uint8_t NLevels;
+  uint8_t Decimation;
+  uint8_t NChannels;
+  int16_t *Memory;
+
+  size_t Head[MaxLevels];     // index of the current bin of each level.
+  size_t Filled[MaxLevels];   // number of completed bins of each level.
+  uint8_t Count[MaxLevels];   // completed bins not yet passed to the next level.
+  size_t BinFill;             // frames in the current bin of the lowest level.
+
+};
+
+
+#endif
@@ -0,0 +1,69 @@
+#include <RMSDetector.h>
+
+
+RMSDetector::RMSDetector(float threshold, float window) :
+  Detector(),
+  Threshold(threshold),
+  Window(window),
+  WindowFrames(1),
+  Frames(0),
+  Count(0),
+  Sum(0),
+  Power(0) {
+}
+
+
+void RMSDetector::setThreshold(float threshold) {
+  Threshold = threshold;
+}
+
+
+void RMSDetector::setWindow(float window) {
+  Window = window;
+}
+
+
+float RMSDetector::rms() const {
+  return sqrt(Power);
+}
+
+
+void RMSDetector::start(uint8_t nchannels, float rate,
+			uint8_t dataresolution) {
+  Detector::start(nchannels, rate, dataresolution);
+  WindowFrames = size_t(Window*Rate);
+  if (WindowFrames < 1)
+    WindowFrames = 1;
+  Frames = 0;
+  Count = 0;
+  Sum = 0;
+  Power = 0;
+}
+
+
+float RMSDetector::value(sample_t x) {
+  return x*Scale;
+}
+
+
+ssize_t RMSDetector::detect(const volatile sample_t *data, size_t nsamples) {
+  ssize_t event = -1;
+  float thresh2 = Threshold*Threshold;
+  for (size_t k=0; k<nsamples; k++) {
+    if (selected()) {
+      float x = value(data[k]);
+      Sum += x*x;
+      Count++;
+    }
+    nextChannel();
+    if (CChannel == 0 && ++Frames >= WindowFrames) {
+      Power = Count > 0 ? Sum/Count : 0;
+      if (event < 0 && Power >= thresh2)
+	event = k;
+      Frames = 0;
+      Count = 0;
+      Sum = 0;
+    }
+  }
+  return event;
+}
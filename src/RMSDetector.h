@@ -0,0 +1,68 @@
+/*
+  RMSDetector - Detect events by thresholding the RMS of the signal.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+#ifndef RMSDetector_h
+#define RMSDetector_h
+
+
+#include <Detector.h>
+
+
+class RMSDetector : public Detector {
+
+ public:
+
+  // Construct detector with a threshold for the RMS relative to the
+  // full range of the data (between 0 and 1) computed on consecutive
+  // windows of window seconds.
+  RMSDetector(float threshold=0.1, float window=0.01);
+
+  // The threshold relative to the full range of the data.
+  float threshold() const { return Threshold; };
+
+  // Set the threshold relative to the full range of the data
+  // (between 0 and 1).
+  void setThreshold(float threshold);
+
+  // The window in seconds on which the RMS is computed.
+  float window() const { return Window; };
+
+  // Set the window in seconds on which the RMS is computed.
+  // Takes effect at the next call of start().
+  void setWindow(float window);
+
+  // The RMS of the last completed window relative to the full range
+  // of the data.
+  float rms() const;
+
+  // Initialize the RMS computation.
+  virtual void start(uint8_t nchannels, float rate,
+		     uint8_t dataresolution=16);
+
+  // Return the index of the last sample of the first window whose
+  // RMS is equal to or exceeds the threshold, or -1.
+  // The RMS is computed over all selected channels.
+  virtual ssize_t detect(const volatile sample_t *data, size_t nsamples);
+
+
+ protected:
+
+  // Return the value of sample x of the current channel CChannel
+  // relative to the full range of the data, whose square is added to
+  // the RMS. Reimplement this function for filtering the data.
+  virtual float value(sample_t x);
+
+  float Threshold;
+  float Window;
+  size_t WindowFrames; // number of frames of a window.
+  size_t Frames;       // number of frames in current window.
+  size_t Count;        // number of samples in current window.
+  float Sum;           // sum of squares in current window.
+  float Power;         // mean squared value of last window.
+
+};
+
+
+#endif
@@ -0,0 +1,312 @@
+#include <RegisterCache.h>
+
+
+// #define DEBUG 1
+
+
+RegisterCache::RegisterCache(TwoWire &wire, uint8_t address,
+			     uint8_t pageswitches, uint8_t writedelay) :
+  I2CBus(&wire),
+  I2CAddress(address),
+  PageSwitches(pageswitches > 0 ? pageswitches : 1),
+  WriteDelay(writedelay),
+  CurrentPage(-1),
+  Batch(0) {
+  memset(Volatile, 0, sizeof(Volatile));
+  set(Volatile, 0x00);   // page register
+  invalidate();
+}
+
+
+void RegisterCache::setBus(TwoWire &wire, uint8_t address) {
+  I2CBus = &wire;
+  I2CAddress = address;
+  invalidate();
+}
+
+
+void RegisterCache::setVolatile(uint8_t first, uint8_t last) {
+  for (uint16_t reg=first; reg<=last && reg<NRegisters; reg++) {
+    set(Volatile, reg);
+    clear(Valid, reg);
+    clear(Dirty, reg);
+  }
+}
+
+
+void RegisterCache::invalidate() {
+  memset(Valid, 0, sizeof(Valid));
+  memset(Dirty, 0, sizeof(Dirty));
+  CurrentPage = -1;
+  memset(Written, 0, sizeof(Written));
+  Batch = 0;
+}
+
+
+bool RegisterCache::fetch(uint8_t first, uint8_t last) {
+  if (last >= NRegisters)
+    last = NRegisters - 1;
+  uint8_t result = goToPage(0);
+  if (result != 0)
+    return false;
+  uint16_t reg = first;
+  while (reg <= last) {
+    uint8_t n = last + 1 - reg;
+    if (n > MaxBurst)
+      n = MaxBurst;
+    result = readBurst(reg, &Values[reg], n);
+    if (result != 0) {
+#ifdef DEBUG
+      Serial.printf("RegisterCache: fetch() failed to read %d registers from %02x, error = %02x\n", n, reg, result);
+#endif
+      return false;
+    }
+    for (uint8_t k=0; k<n; k++) {
+      if (!isSet(Volatile, reg + k) && !isSet(Dirty, reg + k))
+	set(Valid, reg + k);
+    }
+    reg += n;
+  }
+  return true;
+}
+
+
+unsigned int RegisterCache::read(uint16_t address) {
+  if (cached(address) && isSet(Valid, address))
+    return Values[address];
+  uint8_t reg = (uint8_t) (address & 0xFF);
+  uint8_t page = (uint8_t) ((address >> 8) & 0xFF);
+  uint8_t result = goToPage(page);
+  if (result != 0) {
+#ifdef DEBUG
+    Serial.printf("RegisterCache: read() failed to go to page %02x, error = %02x\n", page, result);
+#endif
+    return 0x0100;
+  }
+  uint8_t val;
+  result = readBurst(reg, &val, 1);
+  if (result == 0xff) {
+    Serial.printf("RegisterCache: empty read() on page %02x reg %02x\n", page, reg);
+    return 0x0400;
+  }
+  if (result != 0) {
+#ifdef DEBUG
+    Serial.printf("RegisterCache: read() failed to write reg %02x on page %02x, error = %02x\n", reg, page, result);
+#endif
+    return 0x0200 + result;
+  }
+  if (cached(address)) {
+    Values[address] = val;
+    set(Valid, address);
+  }
+  return val;
+}
+
+
+bool RegisterCache::write(uint16_t address, uint8_t val) {
+  if (cached(address)) {
+    if (isSet(Valid, address) && Values[address] == val)
+      return true;
+    if (Batch > 0) {
+      Values[address] = val;
+      set(Valid, address);
+      set(Dirty, address);
+      return true;
+    }
+  }
+  else if (Batch > 0) {
+    // keep the order of writes:
+    if (!writeDirty())
+      return false;
+  }
+  uint8_t reg = (uint8_t) (address & 0xFF);
+  uint8_t page = (uint8_t) ((address >> 8) & 0xFF);
+  uint8_t result = goToPage(page);
+  if (result != 0) {
+#ifdef DEBUG
+    Serial.printf("RegisterCache: write() failed to go to page %02x, error = %02x\n", page, result);
+#endif
+    return false;
+  }
+  result = writeBurst(reg, &val, 1);
+  if (result != 0) {
+#ifdef DEBUG
+    Serial.printf("RegisterCache: write() failed, error = %02x\n", result);
+#endif
+    if (cached(address))
+      clear(Valid, address);
+    return false;
+  }
+  if (reg == 0x00)
+    CurrentPage = val;
+  if (cached(address)) {
+    Values[address] = val;
+    set(Valid, address);
+    set(Written, address);
+  }
+  return true;
+}
+
+
+void RegisterCache::beginBatch() {
+  Batch++;
+}
+
+
+void RegisterCache::endBatch() {
+  if (Batch > 0)
+    Batch--;
+}
+
+
+bool RegisterCache::flush() {
+  endBatch();
+  if (Batch > 0)
+    return true;
+  return writeDirty();
+}
+
+
+bool RegisterCache::writeDirty() {
+  bool success = true;
+  int reg = nextDirty(0);
+  while (reg >= 0) {
+    if (!writeRun(reg))
+      success = false;
+    reg = nextDirty(reg);
+  }
+  return success;
+}
+
+
+int RegisterCache::nextDirty(uint8_t reg) const {
+  for (int r=reg; r<NRegisters; r++) {
+    if (isSet(Dirty, r))
+      return r;
+  }
+  return -1;
+}
+
+
+bool RegisterCache::writeRun(uint8_t reg) {
+  if (reg >= NRegisters || !isSet(Dirty, reg))
+    return true;
+  uint8_t n = runLength(Dirty, reg, true);
+  uint8_t result = goToPage(0);
+  if (result == 0)
+    result = writeBurst(reg, &Values[reg], n);
+  for (uint8_t k=0; k<n; k++) {
+    clear(Dirty, reg + k);
+    if (result != 0)
+      clear(Valid, reg + k);
+    else
+      set(Written, reg + k);
+  }
+  if (result != 0) {
+#ifdef DEBUG
+    Serial.printf("RegisterCache: writeRun() failed to write %d registers from %02x, error = %02x\n", n, reg, result);
+#endif
+    return false;
+  }
+  return true;
+}
+
+
+bool RegisterCache::verify() {
+  bool success = true;
+  uint8_t vals[MaxBurst];
+  for (uint16_t reg=0; reg<NRegisters; reg++) {
+    if (!isSet(Written, reg))
+      continue;
+    uint8_t n = runLength(Written, reg, false);
+    uint8_t result = goToPage(0);
+    if (result == 0)
+      result = readBurst(reg, vals, n);
+    if (result != 0) {
+      Serial.printf("ERROR in RegisterCache::verify(): failed to read registers of device %02x, error = %02x\n", I2CAddress, result);
+      return false;
+    }
+    for (uint8_t k=0; k<n; k++) {
+      uint8_t r = reg + k;
+      clear(Written, r);
+      if (!isSet(Valid, r) || isSet(Dirty, r))
+	continue;
+      if (vals[k] != Values[r]) {
+	Serial.printf("WARNING in RegisterCache::verify(): register %02x of device %02x is %02x instead of %02x\n",
+		      r, I2CAddress, vals[k], Values[r]);
+	Values[r] = vals[k];
+	success = false;
+      }
+    }
+    reg += n - 1;
+  }
+  return success;
+}
+
+
+uint8_t RegisterCache::runLength(const uint8_t *bits, uint8_t reg,
+				 bool valid) const {
+  uint8_t n = 0;
+  while (reg + n < NRegisters && n < MaxBurst) {
+    if (isSet(bits, reg + n)) {
+      n++;
+      continue;
+    }
+    // bridge small gap of cached registers:
+    uint8_t g = 0;
+    while (g < MaxGap && reg + n + g < NRegisters &&
+	   !isSet(bits, reg + n + g) && cached(reg + n + g) &&
+	   (!valid || isSet(Valid, reg + n + g)))
+      g++;
+    if (reg + n + g < NRegisters && isSet(bits, reg + n + g) &&
+	n + g < MaxBurst)
+      n += g;
+    else
+      break;
+  }
+  return n;
+}
+
+
+uint8_t RegisterCache::goToPage(uint8_t page) {
+  if (CurrentPage == page)
+    return 0;
+  uint8_t result = 0;
+  for (uint8_t k=0; k<PageSwitches; k++) {
+    result = writeBurst(0x00, &page, 1);
+    if (result != 0) {
+      CurrentPage = -1;
+      return result;
+    }
+  }
+  CurrentPage = page;
+  return 0;
+}
+
+
+uint8_t RegisterCache::writeBurst(uint8_t reg, const uint8_t *vals,
+				  uint8_t n) {
+#ifdef DEBUG
+  Serial.printf("RegisterCache: write page %02x, reg %02x, %d values\n", CurrentPage, reg, n);
+#endif
+  I2CBus->beginTransmission(I2CAddress);
+  I2CBus->write(reg);
+  I2CBus->write(vals, n);
+  uint8_t result = I2CBus->endTransmission();
+  delay(WriteDelay);
+  return result;
+}
+
+
+uint8_t RegisterCache::readBurst(uint8_t reg, uint8_t *vals, uint8_t n) {
+  I2CBus->beginTransmission(I2CAddress);
+  I2CBus->write(reg);
+  uint8_t result = I2CBus->endTransmission(false);
+  if (result != 0)
+    return result;
+  if (I2CBus->requestFrom(I2CAddress, n) < n)
+    return 0xff;
+  for (uint8_t k=0; k<n; k++)
+    vals[k] = I2CBus->read();
+  return 0;
+}
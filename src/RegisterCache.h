@@ -0,0 +1,171 @@
+/*
+  RegisterCache - Cached access to the paged registers of an I2C device.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+/*
+  Addresses of registers are 16 bit, the MSB is the page and the LSB
+  the register on that page. Register 0x00 of each page selects the
+  page. The current page is tracked, so that the page register is only
+  written when the page actually changes.
+
+  The values of the registers on page 0 are cached. Reading a cached
+  register does not touch the I2C bus, and writing a register with the
+  value it already has is skipped. Registers that are changed by the
+  device itself (status registers, reset bits) need to be marked as
+  volatile with setVolatile(). They are never cached. Registers on
+  other pages are not cached either.
+
+  Writes between beginBatch() and flush() are only marked as dirty
+  in the cache. flush() writes them in address order, consecutive
+  dirty registers and small gaps between them in a single burst
+  transaction. Batches can be nested, only the outermost flush()
+  writes. fetch() reads a range of registers into the cache using
+  burst transactions, and verify() reads back the registers written
+  since its last call.
+
+  Usage:
+
+  RegisterCache regs(Wire, 0x4A);
+  regs.setVolatile(0x72, 0x78);
+  regs.fetch(0x01, 0x7F);
+  unsigned int val = regs.read(0x0005);
+  regs.beginBatch();
+  regs.write(0x0001, 0x10);
+  regs.write(0x0002, 0x10);
+  regs.flush();
+*/
+
+#ifndef RegisterCache_h
+#define RegisterCache_h
+
+
+#include <Arduino.h>
+#include <Wire.h>
+
+
+class RegisterCache {
+
+ public:
+
+  // Number of cached registers of page 0.
+  static const uint8_t NRegisters = 128;
+
+  // Maximum number of bytes transferred in a single burst transaction.
+  static const uint8_t MaxBurst = 30;
+
+  // Maximum number of cached registers between two runs of registers
+  // that are bridged by a single burst transaction.
+  static const uint8_t MaxGap = 3;
+
+  // Access registers of device at address on I2C bus wire.
+  // Each switch of the page is written pageswitches times.
+  // After each write transaction wait for writedelay milliseconds.
+  RegisterCache(TwoWire &wire, uint8_t address, uint8_t pageswitches=1,
+		uint8_t writedelay=0);
+
+  // Set I2C bus and address of the device and invalidate the cache.
+  void setBus(TwoWire &wire, uint8_t address);
+
+  // Mark registers first to last of page 0 as volatile.
+  void setVolatile(uint8_t first, uint8_t last);
+
+  // Forget all cached values and the current page,
+  // e.g. after a reset of the device.
+  void invalidate();
+
+  // Read the non-volatile registers first to last of page 0 into the
+  // cache using burst transactions.
+  // Return false on I2C error.
+  bool fetch(uint8_t first, uint8_t last);
+
+  // Value of the register at address, from the cache if possible.
+  // Return values larger than 0xff on I2C error.
+  unsigned int read(uint16_t address);
+
+  // Write val to the register at address.
+  // Skipped if the cache knows that the register already holds val.
+  // Between beginBatch() and flush() only the cache is updated.
+  // Return false on I2C error.
+  bool write(uint16_t address, uint8_t val);
+
+  // Defer writes to cached registers until flush().
+  void beginBatch();
+
+  // End a batch without writing dirty registers.
+  void endBatch();
+
+  // True while writes are deferred.
+  bool batching() const { return Batch > 0; };
+
+  // End a batch. At the end of the outermost batch write all dirty
+  // registers, consecutive ones in single burst transactions.
+  // Return false on I2C error.
+  bool flush();
+
+  // Write all dirty registers right away.
+  // Return false on I2C error.
+  bool writeDirty();
+
+  // First dirty register at or after reg, -1 if there is none.
+  int nextDirty(uint8_t reg) const;
+
+  // Write the consecutive dirty registers starting at reg in a single
+  // burst transaction. Gaps of up to MaxGap cached registers are
+  // bridged by writing their cached values.
+  // Return false on I2C error.
+  bool writeRun(uint8_t reg);
+
+  // Read back all cached registers written since the last call
+  // using burst transactions and compare them with the cache.
+  // Mismatches are reported on Serial and the cache is corrected.
+  // Return false on mismatch or I2C error.
+  bool verify();
+
+
+ protected:
+
+  // Switch to page if not already there.
+  uint8_t goToPage(uint8_t page);
+
+  // Write n values to consecutive registers starting at reg of the
+  // current page.
+  uint8_t writeBurst(uint8_t reg, const uint8_t *vals, uint8_t n);
+
+  // Read n values from consecutive registers starting at reg of the
+  // current page.
+  uint8_t readBurst(uint8_t reg, uint8_t *vals, uint8_t n);
+
+  // True if the register reg of page 0 is cached.
+  bool cached(uint16_t address) const
+    { return (address < NRegisters) && !isSet(Volatile, address); };
+
+  // Number of registers of a single burst transaction covering the
+  // registers set in bits starting at reg. Bridges gaps of up to
+  // MaxGap cached registers (that also need to be valid if valid is true).
+  uint8_t runLength(const uint8_t *bits, uint8_t reg, bool valid) const;
+
+  static bool isSet(const uint8_t *bits, uint8_t reg)
+    { return bits[reg >> 3] & (1 << (reg & 0x07)); };
+  static void set(uint8_t *bits, uint8_t reg)
+    { bits[reg >> 3] |= (1 << (reg & 0x07)); };
+  static void clear(uint8_t *bits, uint8_t reg)
+    { bits[reg >> 3] &= ~(1 << (reg & 0x07)); };
+
+  TwoWire *I2CBus;
+  uint8_t I2CAddress;
+  uint8_t PageSwitches;
+  uint8_t WriteDelay;
+  int CurrentPage;     // -1 if unknown.
+  uint8_t Batch;       // depth of nested batches.
+
+  uint8_t Values[NRegisters];
+  uint8_t Valid[NRegisters/8];
+  uint8_t Dirty[NRegisters/8];
+  uint8_t Written[NRegisters/8];   // written since last verify().
+  uint8_t Volatile[NRegisters/8];
+
+};
+
+
+#endif
@@ -0,0 +1,138 @@
+#include <Resampler.h>
+
+
+Resampler::Resampler() :
+  InRate(0),
+  OutRate(0),
+  NTaps(2),
+  Coefs(0),
+  StepInt(1),
+  StepFrac(0),
+  Frac(0),
+  HistPos(0) {
+  memset(HistLeft, 0, sizeof(HistLeft));
+  memset(HistRight, 0, sizeof(HistRight));
+}
+
+
+Resampler::~Resampler() {
+  if (Coefs != 0)
+    free(Coefs);
+}
+
+
+bool Resampler::setup(float inrate, float outrate) {
+  if (inrate <= 0 || outrate <= 0)
+    return false;
+  // cutoff frequency relative to input rate:
+  float fc = 0.42;
+  if (outrate < inrate)
+    fc *= outrate/inrate;
+  // six zero crossings on each side:
+  uint16_t ntaps = 2*ceil(3.0/fc);
+  if (ntaps > MaxTaps)
+    ntaps = MaxTaps;
+  int16_t *coefs = (int16_t *)malloc(NPhases*ntaps*sizeof(int16_t));
+  if (coefs == 0) {
+    Serial.printf("ERROR in Resampler::setup(): not enough memory for %u filter coefficients.\n", NPhases*ntaps);
+    return false;
+  }
+  if (Coefs != 0)
+    free(Coefs);
+  Coefs = coefs;
+  NTaps = ntaps;
+  InRate = inrate;
+  OutRate = outrate;
+  float width = 0.5*NTaps;
+  for (uint16_t p=0; p<NPhases; p++) {
+    float mu = float(p)/NPhases;
+    float h[MaxTaps];
+    float sum = 0.0;
+    for (uint16_t i=0; i<NTaps; i++) {
+      // time of sample i relative to output sample:
+      float t = width - 1 - i + mu;
+      float x = 2.0*fc*t;
+      float sinc = fabs(x) < 1e-6 ? 1.0 : sin(PI*x)/(PI*x);
+      // Blackman window:
+      float w = 0.42 + 0.5*cos(PI*t/width) + 0.08*cos(2.0*PI*t/width);
+      if (fabs(t) >= width)
+	w = 0.0;
+      h[i] = sinc*w;
+      sum += h[i];
+    }
+    // normalize to unity gain:
+    for (uint16_t i=0; i<NTaps; i++)
+      Coefs[p*NTaps + i] = (int16_t)roundf(32767.0*h[i]/sum);
+  }
+  double step = double(inrate)/double(outrate);
+  StepInt = (uint32_t)step;
+  StepFrac = (uint32_t)((step - StepInt)*4294967296.0);
+  reset();
+  return true;
+}
+
+
+bool Resampler::ready(float inrate, float outrate) const {
+  return (Coefs != 0 && InRate == inrate && OutRate == outrate);
+}
+
+
+void Resampler::reset() {
+  Frac = 0;
+  HistPos = 0;
+  memset(HistLeft, 0, sizeof(HistLeft));
+  memset(HistRight, 0, sizeof(HistRight));
+}
+
+
+template <typename T>
+static inline void swapValues(T &a, T &b) {
+  T t = a;
+  a = b;
+  b = t;
+}
+
+
+void Resampler::swap(Resampler &other) {
+  swapValues(InRate, other.InRate);
+  swapValues(OutRate, other.OutRate);
+  swapValues(NTaps, other.NTaps);
+  swapValues(Coefs, other.Coefs);
+  swapValues(StepInt, other.StepInt);
+  swapValues(StepFrac, other.StepFrac);
+  swapValues(Frac, other.Frac);
+  for (uint16_t k=0; k<2*MaxTaps; k++) {
+    swapValues(HistLeft[k], other.HistLeft[k]);
+    swapValues(HistRight[k], other.HistRight[k]);
+  }
+  swapValues(HistPos, other.HistPos);
+}
+
+
+size_t Resampler::frames(size_t n) const {
+  uint64_t step = ((uint64_t)StepInt << 32) | StepFrac;
+  return (size_t)((n*step + Frac) >> 32) + 1;
+}
+
+
+void Resampler::output(int16_t &left, int16_t &right) const {
+  if (Coefs == 0) {
+    left = 0;
+    right = 0;
+    return;
+  }
+  // the upper 6 bits of Frac select one of the 64 phases:
+  const int16_t *coefs = &Coefs[(Frac >> 26)*NTaps];
+  const int16_t *xl = &HistLeft[HistPos];
+  const int16_t *xr = &HistRight[HistPos];
+  int32_t accl = 0;
+  int32_t accr = 0;
+  for (uint16_t i=0; i<NTaps; i++) {
+    accl += coefs[i]*xl[i];
+    accr += coefs[i]*xr[i];
+  }
+  accl >>= 15;
+  accr >>= 15;
+  left = accl > 32767 ? 32767 : (accl < -32768 ? -32768 : accl);
+  right = accr > 32767 ? 32767 : (accr < -32768 ? -32768 : accr);
+}
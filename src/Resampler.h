@@ -0,0 +1,117 @@
+/*
+  Resampler - Fixed-point polyphase resampler for stereo 16-bit data.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+/*
+  The input frames are pushed into a short history. Output samples
+  are computed from the history by a windowed-sinc low-pass filter
+  with a cutoff at 42% of the lower of the two sampling rates,
+  interpolated at NPhases fractional positions between input samples.
+  Filter coefficients are precomputed in Q15 by setup().
+  The position in the input is advanced by a 32.32 fixed-point
+  phase increment.
+
+  Usage:
+
+  Resampler resampler;
+  resampler.setup(96000, 44100);
+  for (...) {
+    resampler.output(left, right);
+    size_t n = resampler.advance();
+    for (size_t k=0; k<n; k++)
+      resampler.push(inleft[j], inright[j++]);
+  }
+*/
+
+#ifndef Resampler_h
+#define Resampler_h
+
+
+#include <Arduino.h>
+
+
+class Resampler {
+
+ public:
+
+  // Number of fractional phases between input samples.
+  static const uint16_t NPhases = 64;
+
+  // Maximum number of filter taps per phase.
+  static const uint16_t MaxTaps = 64;
+
+  Resampler();
+  ~Resampler();
+
+  // Compute the polyphase filter for resampling from inrate to outrate
+  // and reset the resampler.
+  // This takes some time and should not be called from an interrupt.
+  // Return false if memory for the filter could not be allocated.
+  bool setup(float inrate, float outrate);
+
+  // True if the filter has been set up for resampling from inrate
+  // to outrate.
+  bool ready(float inrate, float outrate) const;
+
+  // Sampling rate of the input in Hertz.
+  float inRate() const { return InRate; };
+
+  // Sampling rate of the output in Hertz.
+  float outRate() const { return OutRate; };
+
+  // Number of filter taps per phase.
+  uint16_t taps() const { return NTaps; };
+
+  // Clear history and phase.
+  void reset();
+
+  // Exchange filter and state with other resampler.
+  void swap(Resampler &other);
+
+  // Maximum number of input frames needed for the next n output samples.
+  size_t frames(size_t n) const;
+
+  // Add an input frame to the history.
+  void push(int16_t left, int16_t right) {
+    HistLeft[HistPos] = left;
+    HistLeft[HistPos + NTaps] = left;
+    HistRight[HistPos] = right;
+    HistRight[HistPos + NTaps] = right;
+    if (++HistPos >= NTaps)
+      HistPos = 0;
+  };
+
+  // Compute output sample at the current phase.
+  void output(int16_t &left, int16_t &right) const;
+
+  // Advance phase by one output sample.
+  // Return the number of input frames to be pushed before the next
+  // call of output().
+  size_t advance() {
+    uint32_t frac = Frac + StepFrac;
+    size_t n = StepInt + (frac < Frac ? 1 : 0);
+    Frac = frac;
+    return n;
+  };
+
+
+ protected:
+
+  float InRate;
+  float OutRate;
+  uint16_t NTaps;
+  int16_t *Coefs;     // NPhases*NTaps filter coefficients in Q15.
+  uint32_t StepInt;   // integer part of phase increment.
+  uint32_t StepFrac;  // fractional part of phase increment.
+  uint32_t Frac;      // current fractional phase.
+
+  // History of input samples, stored twice for contiguous access:
+  int16_t HistLeft[2*MaxTaps];
+  int16_t HistRight[2*MaxTaps];
+  uint16_t HistPos;
+
+};
+
+
+#endif
@@ -1,4 +1,5 @@
 #include <TimeLib.h>
+#include <WaveHeader.h>
 #include <SDCard.h>
 
 
@@ -13,7 +14,8 @@ void SDCardDateTime(uint16_t* date, uint16_t* time) {
 SDCard::SDCard(const char *name) :
   Available(false),
   SDIOCSPin(-1),
-  NameCounter(0) {
+  NameCounter(0),
+  CounterName("") {
   if (name == 0)
     strcpy(Name, "");
   else {
@@ -139,6 +141,11 @@ bool SDCard::isBusy() {
 }
 
 
+bool SDCard::isExFAT() {
+  return (Available && sdfs.fatType() > 32);
+}
+
+
 bool SDCard::dataDir(const char *path, bool new_dir) {
   if (! Available)
     return false;
@@ -168,7 +175,35 @@ bool SDCard::dataDir(const char *path, bool new_dir) {
       width = *(num + 3) - '0';
       offs = 4;
     }
-    for (int i=1; i<=99; i++) {
+    // skip numbers already in use:
+    int i0 = 1;
+    const char *slash = num;
+    while (slash > opath && *(slash - 1) != '/')
+      slash--;
+    char parent[MaxDir];
+    char prefix[MaxDir];
+    char suffix[MaxDir];
+    size_t np = slash - opath;
+    if (np > 1)
+      np--;            // strip trailing slash
+    if (np > 0 && np < MaxDir) {
+      memcpy(parent, opath, np);
+      parent[np] = '\0';
+    }
+    else if (np == 0 && (WorkingDir[0] == '\0' || strcmp(WorkingDir, "/") == 0))
+      strcpy(parent, "/");
+    else
+      parent[0] = '\0';
+    np = num - slash;
+    memcpy(prefix, slash, np);
+    prefix[np] = '\0';
+    strncpy(suffix, num + offs, MaxDir);
+    suffix[MaxDir - 1] = '\0';
+    if (parent[0] != '\0' && strchr(suffix, '/') == NULL)
+      i0 = highestNumber(parent, prefix, width, false, suffix, true) + 1;
+    if (i0 > 99)
+      i0 = 1;          // all numbers used up, look for gaps
+    for (int i=i0; i<=99; i++) {
       size_t n = num - opath;
       memcpy(new_path, opath, n);
       snprintf(new_path + n, MaxDir - n, "%0*d%s", width, i, num + offs);
@@ -181,7 +216,7 @@ bool SDCard::dataDir(const char *path, bool new_dir) {
       }
     }
   }
-  NameCounter = 0;
+  resetFileCounter();
   bool r = sdfs.chdir(npath);
   if (r) {
     strncpy(WorkingDir, npath, MaxDir);
@@ -261,6 +296,51 @@ bool remove_file(SDClass &sdc, const char *path, const char *fname,
 }
 
 
+bool SDCard::repairWave(FsFile &file) {
+  char buffer[WaveHeader::MaxBuffer];
+  file.rewind();
+  int n = file.read(buffer, WaveHeader::MaxBuffer);
+  if (n <= 0)
+    return false;
+  WaveHeader wave;
+  if (!wave.parse(buffer, n))
+    return false;
+  if (!wave.setFileSize(file.fileSize()))
+    return false;
+  file.rewind();
+  if (file.write(wave.Buffer, wave.NBuffer) != wave.NBuffer)
+    return false;
+  file.sync();
+  return true;
+}
+
+
+int SDCard::repairWaveFiles(const char *path, Stream &stream) {
+  if (!checkAvailability(stream))
+    return 0;
+  FsFile dir = sdfs.open(path);
+  if (!dir) {
+    stream.printf("Folder \"%s\" does not exist on %sSD card.\n", path, Name);
+    return 0;
+  }
+  int n_repaired = 0;
+  FsFile file;
+  while (file.openNext(&dir, O_RDWR)) {
+    char fname[64];
+    file.getName(fname, 64);
+    size_t n = strlen(fname);
+    if (!file.isDir() && n > 4 && strcasecmp(fname + n - 4, ".wav") == 0 &&
+	repairWave(file)) {
+      stream.printf("  repaired wave header of \"%s/%s\"\n", path, fname);
+      n_repaired++;
+    }
+    file.close();
+  }
+  dir.close();
+  return n_repaired;
+}
+
+
 int SDCard::cleanDir(const char *path, uint64_t min_size, const char *suffix,
 		     bool associated, const char *alt_suffix, bool remove, Stream &stream) {
   if (!checkAvailability(stream))
@@ -816,6 +896,236 @@ void SDCard::benchmark(size_t buffer_size, uint32_t file_size, int repeats,
 }
 
 
+void SDCard::benchmarkSweep(uint32_t file_size, Stream &stream) {
+  if (!checkAvailability(stream))
+    return;
+  const size_t max_buffer = 32768;
+  uint32_t *buf32 = (uint32_t *)malloc(max_buffer + 4);
+  if (buf32 == 0) {
+    stream.println("! ERROR: Not enough memory for benchmark buffer.\n");
+    return;
+  }
+  uint8_t* buf = (uint8_t*)buf32;
+  for (size_t i=0; i<max_buffer + 4; i++)
+    buf[i] = 'A' + (i % 26);
+  FsFile file = sdfs.open("bench.dat", O_RDWR | O_CREAT | O_TRUNC);
+  if (!file) {
+    stream.printf("! ERROR: Failed to create 'bench.dat' file on %sSD card.\n\n", Name);
+    ::free(buf32);
+    return;
+  }
+  stream.printf("Benchmarking write speeds of %sSD card for various buffer sizes and alignments\n", Name);
+  stream.println("- 'align' is the offset of the buffer from a 4-byte aligned address.");
+  stream.println("- 'speed' is the average data rate for writing the whole file.");
+  stream.println("- 'max' is the maximum time it takes to write a single buffer.");
+  stream.printf("- file   size: %dMB\n\n", file_size);
+  stream.println("buffer\talign\tspeed\tmax");
+  stream.println("Bytes\tBytes\tMB/s\tms");
+  const size_t offsets[3] = {0, 1, 2};
+  for (size_t buffer_size=512; buffer_size<=max_buffer; buffer_size*=2) {
+    for (size_t j=0; j<3; j++) {
+      file.truncate(0);
+      if (!file.preAllocate(1000000UL*file_size))
+	stream.println("! ERROR: pre-allocation of file failed.\n");
+      uint32_t n = 1000000UL*file_size/buffer_size;
+      uint32_t max_latency = 0;
+      bool skip = true;
+      uint32_t t = millis();
+      for (uint32_t i=0; i<n; i++) {
+	uint32_t m = micros();
+	if (file.write(buf + offsets[j], buffer_size) != buffer_size) {
+	  stream.println("! ERROR: writing to file failed.\n");
+	  break;
+	}
+	m = micros() - m;
+	if (skip)
+	  skip = file.curPosition() < 512;
+	else if (max_latency < m)
+	  max_latency = m;
+      }
+      file.sync();
+      t = millis() - t;
+      float s = file.fileSize();
+      stream.printf("%d\t%d\t%.2f\t%.3f\n", buffer_size, offsets[j],
+		    0.001*s/t, 0.001*max_latency);
+    }
+  }
+  stream.println();
+  file.close();
+  ::free(buf32);
+  if (!sdfs.remove("bench.dat"))
+    stream.println("Failed to remove 'bench.dat'");
+  stream.println("Done");
+  stream.println();
+}
+
+
+// Histogram of latencies in microseconds with eight bins per octave.
+// Latencies below 16us have their own bins, larger ones are binned
+// by the three bits following the leading one, i.e. with a
+// resolution of 12.5% or better.
+static const size_t NLatencyBins = 240;
+
+static size_t latency_bin(uint32_t latency) {
+  if (latency < 16)
+    return latency;
+  uint8_t e = 31 - __builtin_clz(latency);
+  return 8*(e - 2) + ((latency >> (e - 3)) & 7);
+}
+
+static uint32_t bin_latency(size_t bin) {
+  if (bin < 16)
+    return bin;
+  uint8_t e = bin/8 + 2;
+  return ((8 + (bin & 7)) << (e - 3)) + (1 << (e - 4));  // center of bin
+}
+
+static uint32_t latency_percentile(const uint32_t *counts, uint32_t n,
+				   uint32_t percent) {
+  uint32_t k = (uint64_t(percent)*n)/100;
+  uint32_t sum = 0;
+  for (size_t bin=0; bin<NLatencyBins; bin++) {
+    sum += counts[bin];
+    if (sum > k)
+      return bin_latency(bin);
+  }
+  return bin_latency(NLatencyBins - 1);
+}
+
+
+float SDCard::benchmarkRecorder(uint32_t rate, uint8_t nchannels,
+				float write_interval, float file_time,
+				float duration, Stream &stream) {
+  if (!checkAvailability(stream))
+    return -1.0;
+  const size_t major_size = 512;       // as SDWriter::MajorSize
+  const size_t header_size = 512;
+  float data_rate = 2.0*rate*nchannels;
+  // data of a single write interval:
+  size_t max_write = 2*major_size*size_t(ceil(data_rate*write_interval/(2*major_size)));
+  if (max_write < header_size)
+    max_write = header_size;
+  uint8_t *buf = (uint8_t *)malloc(max_write);
+  if (buf == 0) {
+    stream.println("! ERROR: Not enough memory for benchmark buffer.\n");
+    return -1.0;
+  }
+  for (size_t i=0; i<max_write; i++)
+    buf[i] = 'A' + (i % 26);
+  uint32_t latencies[NLatencyBins];
+  memset(latencies, 0, sizeof(latencies));
+  stream.printf("Replay recorder on %sSD card\n", Name);
+  stream.printf("- channels      : %d\n", nchannels);
+  stream.printf("- sampling rate : %dHz\n", rate);
+  stream.printf("- data rate     : %.3fMB/s\n", 1e-6*data_rate);
+  stream.printf("- write interval: %.0fms\n", 1000.0*write_interval);
+  stream.printf("- file time     : %.0fs\n", file_time);
+  stream.printf("- duration      : %.0fs\n\n", duration);
+
+  char fname[16];
+  int nfiles = 0;
+  FsFile file;
+  uint32_t max_latency = 0;
+  uint32_t total_latency = 0;
+  uint32_t max_rotation = 0;
+  uint32_t stalls = 0;
+  uint32_t nwrites = 0;
+  uint64_t written = 0;
+  uint64_t file_written = 0;
+  uint64_t file_bytes = 2*major_size*uint64_t(data_rate*file_time/(2*major_size));
+  float max_backlog = 0;
+  bool failed = false;
+  uint32_t start = micros();
+  uint32_t next = start;
+  uint32_t interval = uint32_t(1e6*write_interval);
+  while (!failed) {
+    // wait for next write:
+    while ((int32_t)(micros() - next) < 0) {};
+    next += interval;
+    float elapsed = 1e-6*(micros() - start);
+    if (elapsed >= duration)
+      break;
+    // rotate file:
+    if (!file || file_written >= file_bytes) {
+      uint32_t m = micros();
+      if (file) {
+	file.seek(0);
+	if (file.write(buf, header_size) != header_size)
+	  failed = true;
+	file.close();
+      }
+      sprintf(fname, "bench%02d.dat", nfiles++);
+      file = sdfs.open(fname, O_RDWR | O_CREAT | O_TRUNC);
+      if (!file || file.write(buf, header_size) != header_size) {
+	stream.printf("! ERROR: Failed to create '%s' file on %sSD card.\n", fname, Name);
+	failed = true;
+      }
+      file_written = 0;
+      m = micros() - m;
+      if (max_rotation < m)
+	max_rotation = m;
+    }
+    // write available data:
+    float backlog = data_rate*elapsed - written;
+    if (max_backlog < backlog)
+      max_backlog = backlog;
+    size_t nbytes = 2*major_size*size_t(backlog/(2*major_size));
+    while (nbytes > 0 && !failed) {
+      size_t n = nbytes < max_write ? nbytes : max_write;
+      uint32_t m = micros();
+      if (file.write(buf, n) != n) {
+	stream.println("! ERROR: writing to file failed.");
+	failed = true;
+      }
+      m = micros() - m;
+      nbytes -= n;
+      written += n;
+      file_written += n;
+      nwrites++;
+      total_latency += m;
+      if (max_latency < m)
+	max_latency = m;
+      if (m > interval)
+	stalls++;
+      latencies[latency_bin(m)]++;
+    }
+  }
+  float t = 1e-6*(micros() - start);
+  if (file) {
+    file.seek(0);
+    file.write(buf, header_size);
+    file.close();
+  }
+  for (int k=0; k<nfiles; k++) {
+    sprintf(fname, "bench%02d.dat", k);
+    sdfs.remove(fname);
+  }
+  ::free(buf);
+  float buffer_time = max_backlog/data_rate + write_interval;
+  if (nwrites > 0) {
+    stream.printf("Sustained data rate: %.3fMB/s\n", 1e-6*written/t);
+    stream.printf("Files written      : %d\n", nfiles);
+    stream.printf("Write calls        : %d\n", nwrites);
+    stream.printf("Average latency    : %.3fms\n", 0.001*total_latency/nwrites);
+    stream.printf("50%% percentile     : %.3fms\n", 0.001*latency_percentile(latencies, nwrites, 50));
+    stream.printf("90%% percentile     : %.3fms\n", 0.001*latency_percentile(latencies, nwrites, 90));
+    stream.printf("99%% percentile     : %.3fms\n", 0.001*latency_percentile(latencies, nwrites, 99));
+    stream.printf("Maximum latency    : %.3fms\n", 0.001*max_latency);
+    stream.printf("Maximum rotation   : %.3fms\n", 0.001*max_rotation);
+    stream.printf("Stalls > interval  : %d\n", stalls);
+    stream.printf("Required buffer    : %.3fs\n", buffer_time);
+  }
+  if (failed) {
+    stream.println("FAILED");
+    stream.println();
+    return -1.0;
+  }
+  stream.println("Done");
+  stream.println();
+  return buffer_time;
+}
+
+
 void SDCard::erase(Stream &stream) {
   uint32_t const ERASE_SIZE = 262144L;
   uint32_t nsectors = 0;
@@ -963,38 +1273,74 @@ String SDCard::incrementFileName(const String &fname, Stream &stream) {
   }
   String aa("aa");
   if (num || anum) {
+    int tinx = anum ? fname.indexOf("ANUM") : numinx;
+    int tlen = anum ? 4 : strlen(nums);
+    String prefix = fname.substring(0, tinx);
+    String suffix = fname.substring(tinx + tlen);
+    String dir = WorkingDir;
+    int slash = prefix.lastIndexOf('/');
+    if (slash >= 0) {
+      dir = slash > 0 ? prefix.substring(0, slash) : "/";
+      prefix = prefix.substring(slash + 1);
+    }
+    if (dir.length() == 0)
+      dir = "/";
+    else if (dir[0] != '/')
+      dir = String("/") + dir;
+    String key = dir + "/" + prefix + "*" + suffix;
+    if (key != CounterName) {
+      // scan directory once for the highest number in use:
+      NameCounter = 0;
+      if (suffix.indexOf('/') < 0)
+	NameCounter = highestNumber(dir.c_str(), prefix.c_str(),
+				    anum ? 2 : width, anum, suffix.c_str(),
+				    false);
+      CounterName = key;
+    }
     String name;
-    do {
+    bool wrapped = false;
+    while (true) {
       name = fname;
       NameCounter++;
+      bool overflow = false;
       if (anum) {
 	aa[1] = char('a' + ((NameCounter-1) % 26));
 	uint16_t major = (NameCounter-1) / 26;
-	if (major > 25) {
-	  stream.printf("WARNING: file name overflow on %sSD card for \"%s\".\n",
-			Name, fname);
-	  return "";
+	if (major > 25)
+	  overflow = true;
+	else {
+	  aa[0] = char('a' + major);
+	  name.replace("ANUM", aa);
 	}
-	aa[0] = char('a' + major);
-	name.replace("ANUM", aa);
       }
       else if (num) {
 	char nn[12];
 	int maxn = 1;
 	for (int w=0; w<width; w++)
 	  maxn *= 10;
-	if (NameCounter > maxn) {
+	if (NameCounter > maxn)
+	  overflow = true;
+	else {
+	  volatile int nn_size = sizeof(nn); // avoid truncation warning: https://stackoverflow.com/a/70938456
+	  snprintf(nn, nn_size, "%0*d", width, NameCounter);
+	  nn[11] = '\0';
+	  name.replace(nums, nn);
+	}
+      }
+      if (overflow) {
+	if (wrapped) {
 	  stream.printf("WARNING: file name overflow on %sSD card for \"%s\".\n",
-			Name, fname);
+			Name, fname.c_str());
 	  return "";
 	}
-	volatile int nn_size = sizeof(nn); // avoid truncation warning: https://stackoverflow.com/a/70938456
-	snprintf(nn, nn_size, "%0*d", width, NameCounter);
-	nn[11] = '\0';
-	name.replace(nums, nn);
+	// highest number in use, look for gaps from the beginning:
+	wrapped = true;
+	NameCounter = 0;
+	continue;
       }
-    } while (sdfs.exists(name.c_str()));
-    return name;
+      if (! sdfs.exists(name.c_str()))
+	return name;
+    }
   }
   else
     return fname;
@@ -1003,6 +1349,51 @@ String SDCard::incrementFileName(const String &fname, Stream &stream) {
     
 void SDCard::resetFileCounter() {
   NameCounter = 0;
+  CounterName = "";
+}
+
+
+int SDCard::highestNumber(const char *dir, const char *prefix, int width,
+			  bool alpha, const char *suffix, bool exact) {
+  FsFile folder = sdfs.open(dir);
+  if (!folder)
+    return 0;
+  size_t np = strlen(prefix);
+  size_t ns = strlen(suffix);
+  int maxn = 0;
+  char name[128];
+  SdFile file;
+  while (file.openNext(&folder, O_RDONLY)) {
+    file.getName(name, sizeof(name));
+    file.close();
+    if (strncmp(name, prefix, np) != 0)
+      continue;
+    const char *c = name + np;
+    int n = 0;
+    int w = 0;
+    for (; w<width; w++, c++) {
+      if (alpha) {
+	if (*c < 'a' || *c > 'z')
+	  break;
+	n = 26*n + (*c - 'a');
+      }
+      else {
+	if (!isdigit(*c))
+	  break;
+	n = 10*n + (*c - '0');
+      }
+    }
+    if (w < width || (!alpha && isdigit(*c)))
+      continue;
+    if (alpha)
+      n++;
+    if (exact ? strcmp(c, suffix) != 0 : strncmp(c, suffix, ns) != 0)
+      continue;
+    if (n > maxn)
+      maxn = n;
+  }
+  folder.close();
+  return maxn;
 }
 
 
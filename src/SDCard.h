@@ -69,10 +69,14 @@ class SDCard : public SDClass {
   // True if SD card is busy.
   bool isBusy();
 
+  // True if SD card is formatted with exFAT.
+  // Only exFAT allows for files larger than 4GB.
+  bool isExFAT();
+
   // Make directory path and make it the currrent working directory.
   // If new_dir and path already exists, then add "-NUM" to path.
-  // If path contains NUM, NUM is replaced by the lowest two-digit number
-  // making it a directory, that does not exist.
+  // If path contains NUM, NUM is replaced by the two-digit number
+  // following the highest one in use for directories of that name.
   // An optional digit following NUM specifies the number of decimals
   // used to format the string, e.g. NUM3 is replaced by "001", "002", etc.
   // Return true on success.
@@ -104,6 +108,15 @@ class SDCard : public SDClass {
 	       bool associated=false, const char *alt_suffix="",
 	       bool remove=true, Stream &stream=Serial);
 
+  // Fix the sizes in the headers of all wave files in path
+  // (non-recursively) according to the actual file sizes.
+  // Only the first sector of each file is read and, if needed, rewritten.
+  // Run this on startup to repair files that have not been closed
+  // properly because of a power loss.
+  // Repaired files are reported on stream.
+  // Return number of repaired files.
+  int repairWaveFiles(const char *path, Stream &stream=Serial);
+
   // List all files in path (non-recursively).
   // If list_dirs, then also list directories in path.
   // If list_sizes, then also print out file sizes in bytes.
@@ -142,6 +155,26 @@ class SDCard : public SDClass {
   void benchmark(size_t buffer_size=512, uint32_t file_size=10,
 		 int repeats=2, Stream &stream=Serial);
 
+  // Run benchmark tests for writing a file_size MB large file with
+  // buffer sizes ranging from 512 bytes to 32kB, each with buffers
+  // aligned to 4 bytes and misaligned by 1 and 2 bytes.
+  // Report data rates and maximum latencies on stream.
+  void benchmarkSweep(uint32_t file_size=4, Stream &stream=Serial);
+
+  // Replay the write pattern of a recording of nchannels channels
+  // sampled with rate Hertz and 16 bit for duration seconds.
+  // Data are written every write_interval seconds in multiples of
+  // 512 samples, files are rotated every file_time seconds including
+  // the rewrite of a wave header.
+  // Report on stream sustained data rate, percentiles of write latencies,
+  // worst-case stalls, and the minimum data buffer required to not
+  // loose any data.
+  // Return the required buffer time in seconds, or a negative number
+  // on failure.
+  float benchmarkRecorder(uint32_t rate, uint8_t nchannels,
+			  float write_interval=0.1, float file_time=10,
+			  float duration=60, Stream &stream=Serial);
+
   // Flash erase all data and report progress on stream.
   void erase(Stream &stream=Serial);
   
@@ -171,6 +204,11 @@ class SDCard : public SDClass {
   // used to format the string, e.g. NUM3 is replaced by "001", "002", etc.
   // If no SD card is available, or if no unique file can be found,
   // return an empty string.
+  // The directory is scanned only once for the highest number
+  // in use for the directory, prefix, and suffix of fname.
+  // Subsequent calls simply increment this number. Only when the
+  // highest possible number is reached, gaps left by removed files
+  // are filled again.
   // This works for only a single fname. You cannot call this function
   // with different fname to increment two or more file names in parallel.
   // Overflows are reported on stream and an empty string is returned.
@@ -202,7 +240,21 @@ class SDCard : public SDClass {
   bool Available;
   int SDIOCSPin;
 
+  // Fix the sizes in the wave header of file according to its file size.
+  // Return true if the header was rewritten.
+  bool repairWave(FsFile &file);
+
+  // Return the highest number replacing NUM (alpha=false, width
+  // digits) or ANUM (alpha=true, width characters) in the names of
+  // files or directories in folder dir that start with prefix and
+  // continue with suffix after the number. If exact, the names need
+  // to end with suffix. Return 0 if no matching name was found.
+  // This scans the directory only once.
+  int highestNumber(const char *dir, const char *prefix, int width,
+		    bool alpha, const char *suffix, bool exact);
+
   uint16_t NameCounter;
+  String CounterName;   // directory, prefix and suffix NameCounter refers to.
 };
 
 
@@ -0,0 +1,183 @@
+#include <DataBuffer.h>
+#include <SDEventWriter.h>
+
+
+SDEventWriter::SDEventWriter(SDCard &sd, const DataWorker &data,
+			     Detector &detector, int verbose) :
+  DataWorker(&data, verbose),
+  Writer(sd, data, verbose),
+  Trigger(&detector),
+  FileName("eventNUM4"),
+  RTC(0),
+  PreTrigger(0.5),
+  HoldOff(1.0),
+  Running(false),
+  Events(0),
+  EventEnd(0),
+  LastEnd(0) {
+}
+
+
+void SDEventWriter::setFileName(const String &fname, const RTClock *rtclock) {
+  FileName = fname;
+  RTC = rtclock;
+}
+
+
+float SDEventWriter::preTrigger() const {
+  return PreTrigger;
+}
+
+
+void SDEventWriter::setPreTrigger(float secs) {
+  PreTrigger = secs;
+  if (rate() > 0 && PreTrigger > 0.5*bufferTime()) {
+    PreTrigger = 0.5*bufferTime();
+    Serial.printf("WARNING in SDEventWriter::setPreTrigger(): pre-trigger time limited to half of the data buffer (%.3fs).\n", PreTrigger);
+  }
+}
+
+
+float SDEventWriter::holdOff() const {
+  return HoldOff;
+}
+
+
+void SDEventWriter::setHoldOff(float secs) {
+  HoldOff = secs;
+}
+
+
+void SDEventWriter::start() {
+  if (!synchronize()) {
+    Serial.println("ERROR in SDEventWriter::start(): data buffer not initialized yet. ");
+    return;
+  }
+  Trigger->start(nchannels(), rate(), dataResolution());
+  Events = 0;
+  EventEnd = 0;
+  LastEnd = 0;
+  Running = true;
+}
+
+
+void SDEventWriter::stop() {
+  Running = false;
+  close();
+}
+
+
+uint64_t SDEventWriter::position(const DataWorker &worker) const {
+  return uint64_t(worker.cycle())*nbuffer() + worker.index();
+}
+
+
+void SDEventWriter::trigger(uint64_t pos) {
+  uint64_t end = pos + samples(HoldOff);
+  if (Writer.isOpen()) {
+    // merge with current event:
+    if (end > EventEnd)
+      EventEnd = end;
+    mark(pos);
+    return;
+  }
+  uint64_t start = pos - pos % nchannels();
+  size_t pre = samples(PreTrigger);
+  start = start > pre ? start - pre : 0;
+  if (start < LastEnd)
+    start = LastEnd;
+  uint64_t head = position(*Producer);
+  size_t maxdecr = nbuffer() - SDWriter::MajorSize;
+  maxdecr -= maxdecr % nchannels();
+  if (head - start > maxdecr)
+    start = head - maxdecr;
+  Writer.start(head - start);
+  EventEnd = end;
+  if (open()) {
+    Events++;
+    mark(pos);
+  }
+}
+
+
+void SDEventWriter::mark(uint64_t pos) {
+  uint64_t start = position(Writer) - Writer.fileSamples();
+  if (pos >= start)
+    Writer.addMarker(uint32_t((pos - start)/nchannels()), "event");
+}
+
+
+bool SDEventWriter::open() {
+  String name = FileName;
+  char dts[20];
+  if (RTC != 0) {
+    name = RTC->makeStr(name, 0, true);
+    RTC->dateTime(dts);
+  }
+  name = Writer.sdcard()->incrementFileName(name);
+  if (name.length() == 0) {
+    Serial.println("WARNING in SDEventWriter::open(): failed to increment file name.");
+    return false;
+  }
+  if (!Writer.openWave(name.c_str(), -1, RTC != 0 ? dts : 0)) {
+    Serial.printf("WARNING in SDEventWriter::open(): failed to open file \"%s\".\n",
+		  name.c_str());
+    return false;
+  }
+  if (Verbose > 0)
+    Serial.printf("SDEventWriter: record event to \"%s\".\n", Writer.name().c_str());
+  return true;
+}
+
+
+void SDEventWriter::close() {
+  if (!Writer.isOpen())
+    return;
+  Writer.closeWave();
+  LastEnd = position(Writer);
+}
+
+
+ssize_t SDEventWriter::update() {
+  if (!Running)
+    return 0;
+  // detect events:
+  size_t missed = overrun();
+  if (missed > 0)
+    Serial.printf("ERROR in SDEventWriter::update(): data overrun! Missed %d samples.\n", missed);
+  size_t navail = available();
+  while (navail > 0) {
+    size_t n = navail;
+    if (Index + n > nbuffer())
+      n = nbuffer() - Index;    // up to the end of the data buffer
+    uint64_t pos = position(*this);
+    ssize_t event = Trigger->detect(&Data->buffer()[Index], n);
+    increment(n);
+    navail -= n;
+    if (event >= 0)
+      trigger(pos + event);
+  }
+  // write event:
+  if (!Writer.isOpen() || !Writer.pending())
+    return 0;
+  ssize_t nwritten = Writer.write();
+  if (nwritten < 0 && nwritten != -2) {
+    close();
+    return nwritten;
+  }
+  if (position(Writer) >= EventEnd)
+    close();
+  else if (Writer.endWrite()) {
+    // continue event in next file:
+    close();
+    open();
+  }
+  return nwritten;
+}
+
+
+void SDEventWriter::reset() {
+  DataWorker::reset();
+  EventEnd = 0;
+  LastEnd = 0;
+}
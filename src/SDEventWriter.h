@@ -0,0 +1,146 @@
+/*
+  SDEventWriter - Write data to SD card only around detected events.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+/*
+  A Detector continuously analyzes the data buffer. When it detects
+  an event, a new wave file is opened that starts a pre-trigger time
+  before the event, taken from the data still stored in the data
+  buffer. The file is written until the hold-off time after the last
+  detected event has expired. Events detected while a file is written
+  extend the recording, such that overlapping events are merged into
+  a single file. Pre-trigger windows never overlap with previously
+  written files. Each detected event is marked in the file by a cue
+  point labeled "event".
+
+  Usage:
+
+  ThresholdDetector detector(0.2);
+  SDCard sdcard;
+  SDEventWriter file(sdcard, aidata, detector);
+
+  void setup() {
+    sdcard.begin();
+    ...
+    file.setFileName("event-SDATETIME", &rtclock);
+    file.setPreTrigger(0.5);
+    file.setHoldOff(2.0);
+    file.writer().setWriteInterval();
+    file.start();
+  }
+
+  void loop() {
+    file.update();
+  }
+*/
+
+#ifndef SDEventWriter_h
+#define SDEventWriter_h
+
+
+#include <Arduino.h>
+#include <DataWorker.h>
+#include <SDCard.h>
+#include <SDWriter.h>
+#include <RTClock.h>
+#include <Detector.h>
+
+
+class SDEventWriter : public DataWorker {
+
+ public:
+
+  // Initialize event writer on SD card detecting events with detector.
+  SDEventWriter(SDCard &sd, const DataWorker &data, Detector &detector,
+		int verbose=0);
+
+  // The writer used for writing the files.
+  // Use it for setting the write interval and the maximum file size.
+  SDWriter &writer() { return Writer; };
+
+  // The detector used for detecting events.
+  Detector &detector() { return *Trigger; };
+
+  // Set the file name for the recorded events.
+  // If rtclock is provided, date and time strings in fname are replaced
+  // by the current time via RTClock::makeStr(), and the date and time
+  // of the recording is stored in the wave header.
+  // Then NUM or ANUM are replaced via SDCard::incrementFileName().
+  void setFileName(const String &fname, const RTClock *rtclock=0);
+
+  // Time in seconds recorded before an event.
+  float preTrigger() const;
+
+  // Set time in seconds recorded before an event.
+  // Limited by the size of the data buffer.
+  void setPreTrigger(float secs);
+
+  // Time in seconds recorded after the last event.
+  float holdOff() const;
+
+  // Set time in seconds recorded after the last event.
+  void setHoldOff(float secs);
+
+  // Start detecting events.
+  void start();
+
+  // Stop detecting events and close a currently written file.
+  void stop();
+
+  // True if events are detected.
+  bool running() const { return Running; };
+
+  // True if an event is currently written to a file.
+  bool recording() const { return Writer.isOpen(); };
+
+  // Number of events that have been recorded since start().
+  // Merged events are counted once.
+  size_t events() const { return Events; };
+
+  // Analyze new data with the detector and write data of
+  // detected events to files.
+  // Call this function as often as possible in loop().
+  // Return the number of written samples or a negative number on error
+  // (see SDWriter::write()).
+  ssize_t update();
+
+  // Data buffer has been initialized.
+  virtual void reset();
+
+
+ protected:
+
+  // Absolute position of worker's index in samples since start of sampling.
+  uint64_t position(const DataWorker &worker) const;
+
+  // Handle event detected at absolute position pos.
+  void trigger(uint64_t pos);
+
+  // Mark event at absolute position pos in the current file.
+  void mark(uint64_t pos);
+
+  // Open a new file for an event. Return true on success.
+  bool open();
+
+  // Close the current file.
+  void close();
+
+  SDWriter Writer;
+  Detector *Trigger;
+
+  String FileName;
+  const RTClock *RTC;
+
+  float PreTrigger;
+  float HoldOff;
+
+  bool Running;
+  size_t Events;
+  uint64_t EventEnd;  // absolute position up to which the event is recorded.
+  uint64_t LastEnd;   // absolute position of the end of the last file.
+
+};
+
+
+#endif
@@ -0,0 +1,300 @@
+#include <DataBuffer.h>
+#include <SDMirrorWriter.h>
+
+
+SDMirrorWriter::SDMirrorWriter(SDCard &sd0, SDCard &sd1,
+			       const DataWorker &producer, int verbose) :
+  DataWorker(&producer, verbose),
+  Writer0(sd0, producer, verbose),
+  Writer1(sd1, producer, verbose),
+  WriteTime(0),
+  WriteInterval(100),
+  FileSamples(0),
+  FileMaxSamples(0) {
+  Writers[0] = &Writer0;
+  Writers[1] = &Writer1;
+  for (size_t k=0; k<NCards; k++)
+    Active[k] = false;
+}
+
+
+size_t SDMirrorWriter::cardsAvailable() const {
+  size_t n = 0;
+  for (size_t k=0; k<NCards; k++) {
+    if (Writers[k]->cardAvailable())
+      n++;
+  }
+  return n;
+}
+
+
+bool SDMirrorWriter::active(size_t index) const {
+  return Active[index] && Writers[index]->isOpen();
+}
+
+
+float SDMirrorWriter::writeInterval() const {
+  return 0.001*WriteInterval;
+}
+
+
+void SDMirrorWriter::setWriteInterval(float time) {
+  if (time < 0)
+    WriteInterval = uint(-1000*time*bufferTime()); // fraction of the buffer
+  else
+    WriteInterval = uint(1000*time);               // time interval in seconds
+  if (0.001*WriteInterval > 0.5*bufferTime())
+    Serial.println("WARNING! SDMirrorWriter::setWriteInterval() interval larger than half the buffer!");
+}
+
+
+bool SDMirrorWriter::pending() {
+  return (isOpen() && WriteTime > WriteInterval);
+}
+
+
+bool SDMirrorWriter::openWave(const char *fname, int64_t samples,
+			      const char *datetime) {
+  bool success = false;
+  for (size_t k=0; k<NCards; k++) {
+    Active[k] = false;
+    if (!Writers[k]->cardAvailable())
+      continue;
+    Active[k] = Writers[k]->openWave(fname, samples, datetime);
+    if (Active[k])
+      success = true;
+    else {
+      if (Writers[k]->isOpen())
+	Writers[k]->close();
+      Serial.printf("WARNING in SDMirrorWriter::openWave(): failed to open file \"%s\" on %sSD card.\n",
+		    fname, Writers[k]->sdcard()->name());
+    }
+  }
+  // writers might have limited the file size,
+  // use the smallest limit of the active writers:
+  FileMaxSamples = 0;
+  for (size_t k=0; k<NCards; k++) {
+    uint64_t maxsamples = Writers[k]->maxFileSamples();
+    if (Active[k] && maxsamples > 0 &&
+	(FileMaxSamples == 0 || maxsamples < FileMaxSamples))
+      FileMaxSamples = maxsamples;
+  }
+  FileSamples = 0;
+  return success;
+}
+
+
+bool SDMirrorWriter::isOpen() const {
+  for (size_t k=0; k<NCards; k++) {
+    if (active(k))
+      return true;
+  }
+  return false;
+}
+
+
+void SDMirrorWriter::close() {
+  catchUp();
+  for (size_t k=0; k<NCards; k++) {
+    if (Writers[k]->isOpen())
+      Writers[k]->close();
+    Active[k] = false;
+  }
+}
+
+
+bool SDMirrorWriter::closeWave() {
+  bool success = catchUp();
+  for (size_t k=0; k<NCards; k++) {
+    if (!Writers[k]->closeWave())
+      success = false;
+    Active[k] = false;
+  }
+  return success;
+}
+
+
+size_t SDMirrorWriter::lag(size_t index) const {
+  return size_t(FileSamples - Writers[index]->fileSamples());
+}
+
+
+ssize_t SDMirrorWriter::writeCard(size_t index, size_t nsamples) {
+  size_t l = lag(index);
+  size_t n = l + nsamples;
+  size_t idx = Index;
+  if (l <= idx)
+    idx -= l;
+  else
+    idx += nbuffer() - l;
+  size_t nwritten = 0;
+  while (nwritten < n) {
+    size_t nw = n - nwritten;
+    if (idx + nw > nbuffer())
+      nw = nbuffer() - idx;       // up to the end of the data buffer
+    ssize_t m = Writers[index]->writeSamples(&Data->buffer()[idx], nw);
+    if (m == -2)                  // file is full
+      break;
+    if (m < 0)
+      return nwritten > 0 ? (ssize_t)nwritten : m;
+    nwritten += m;
+    idx += m;
+    if (idx >= nbuffer())
+      idx -= nbuffer();
+    if ((size_t)m < nw)
+      break;
+  }
+  return nwritten;
+}
+
+
+bool SDMirrorWriter::catchUp() {
+  bool success = true;
+  for (size_t k=0; k<NCards; k++) {
+    while (active(k) && lag(k) > 0) {
+      ssize_t n = writeCard(k, 0);
+      if (n < 0) {
+	drop(k, "failed to write");
+	success = false;
+      }
+      else if (n == 0) {
+	Serial.printf("WARNING in SDMirrorWriter: %sSD card misses the last %d samples of \"%s\".\n",
+		      Writers[k]->sdcard()->name(), lag(k),
+		      Writers[k]->name().c_str());
+	success = false;
+	break;
+      }
+    }
+  }
+  return success;
+}
+
+
+void SDMirrorWriter::drop(size_t index, const char *reason) {
+  Serial.printf("WARNING in SDMirrorWriter: %sSD card %s, stop writing to \"%s\".\n",
+		Writers[index]->sdcard()->name(), reason,
+		Writers[index]->name().c_str());
+  Writers[index]->closeWave();
+  Active[index] = false;
+}
+
+
+ssize_t SDMirrorWriter::write() {
+  if (!isOpen())
+    return -1;
+  size_t missed = overrun();
+  if (missed > 0) {
+    uint32_t wt = WriteTime;
+    Serial.printf("ERROR in SDMirrorWriter::write(): data overrun! Missed %d samples (%.0f%% of buffer, %.0fms).\n", missed, 100.0*missed/nbuffer(), 1000*time(missed));
+    Serial.printf("------> last write %dms ago.\n", wt);
+    return -4;
+  }
+  size_t maxlag = 0;
+  for (size_t k=0; k<NCards; k++) {
+    if (active(k) && lag(k) > maxlag)
+      maxlag = lag(k);
+  }
+  if (FileMaxSamples > 0 && FileSamples >= FileMaxSamples && maxlag == 0)
+    return -2;
+  size_t navail = available();
+  if (navail == 0 && maxlag == 0) {
+    if (0.001*WriteTime > 4*Data->DMABufferTime()) {
+      Serial.println("ERROR in SDMirrorWriter::write(): no data are produced!");
+      return -3;
+    }
+    else
+      return 0;
+  }
+  WriteTime = 0;
+  size_t nwrite = (navail/SDWriter::MajorSize)*SDWriter::MajorSize;
+  if (FileMaxSamples > 0 && nwrite > FileMaxSamples - FileSamples)
+    nwrite = size_t(FileMaxSamples - FileSamples);
+  for (size_t k=0; k<NCards; k++) {
+    if (!active(k) || lag(k) + nwrite == 0)
+      continue;
+    // let a busy card catch up later as long as there is enough room:
+    if (Writers[k]->sdcard()->isBusy() &&
+	lag(k) + navail < nbuffer()/2)
+      continue;
+    if (writeCard(k, nwrite) < 0)
+      drop(k, "failed to write");
+  }
+  if (!isOpen())
+    return -5;
+  // advance to the leading card:
+  uint64_t samples0 = FileSamples;
+  for (size_t k=0; k<NCards; k++) {
+    if (active(k) && Writers[k]->fileSamples() > FileSamples)
+      FileSamples = Writers[k]->fileSamples();
+  }
+  increment(size_t(FileSamples - samples0));
+  // drop cards that are about to loose data:
+  navail = available();
+  for (size_t k=0; k<NCards; k++) {
+    if (active(k) && lag(k) + navail + SDWriter::MajorSize >= nbuffer())
+      drop(k, "can not keep up with the data");
+  }
+  if (!isOpen())
+    return -5;
+  return ssize_t(FileSamples - samples0);
+}
+
+
+void SDMirrorWriter::start(size_t decr) {
+  if (!synchronize())
+    Serial.println("ERROR in SDMirrorWriter::start(): data buffer not initialized yet. ");
+  WriteTime = 0;
+  if (decr > 0) {
+    decrement(decr);
+    WriteTime += int(1000.0*time(decr));
+  }
+  for (size_t k=0; k<NCards; k++)
+    Writers[k]->start(decr);
+}
+
+
+float SDMirrorWriter::fileTime() const {
+  return time(FileSamples);
+}
+
+
+void SDMirrorWriter::setMaxFileSamples(uint64_t samples) {
+  for (size_t k=0; k<NCards; k++)
+    Writers[k]->setMaxFileSamples(samples);
+  FileMaxSamples = Writers[0]->maxFileSamples();
+}
+
+
+void SDMirrorWriter::setRF64(bool rf64) {
+  for (size_t k=0; k<NCards; k++)
+    Writers[k]->setRF64(rf64);
+}
+
+
+void SDMirrorWriter::setMaxFileTime(float secs) {
+  if (rate() == 0)
+    Serial.println("WARNING in SDMirrorWriter::setMaxFileTime(): sampling rate not yet set!");
+  setMaxFileSamples(uint64_t(floor(double(secs)*rate()))*nchannels());
+}
+
+
+uint64_t SDMirrorWriter::maxFileSamples() const {
+  return FileMaxSamples;
+}
+
+
+bool SDMirrorWriter::endWrite() {
+  if (FileMaxSamples == 0 || FileSamples < FileMaxSamples)
+    return false;
+  for (size_t k=0; k<NCards; k++) {
+    if (active(k) && lag(k) > 0)
+      return false;
+  }
+  return true;
+}
+
+
+void SDMirrorWriter::reset() {
+  DataWorker::reset();
+  FileSamples = 0;
+}
@@ -0,0 +1,191 @@
+/*
+  SDMirrorWriter - Write data from a DataWorker to two SD cards simultaneously.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+/*
+  The data buffer is read only once and each block of data is written
+  directly from the data buffer to files on both SD cards.
+  Files are opened, closed, and rotated in lockstep on both cards,
+  such that both cards hold identical files.
+
+  A card that is busy is skipped and catches up later from the data
+  buffer. A card that fails to write or falls too far behind
+  (i.e. it would loose data from the data buffer) is dropped until the
+  next file is opened, while writing continues on the other card.
+
+  Usage:
+
+  SDCard sdcard0("primary");
+  SDCard sdcard1("secondary");
+  SDMirrorWriter file(sdcard0, sdcard1, aidata);
+
+  void setup() {
+    sdcard0.begin();
+    sdcard1.begin(10, DEDICATED_SPI, 24, &SPI);
+    ...
+    file.setWriteInterval();
+    file.setMaxFileTime(60);
+    file.start();
+    file.openWave("rec.wav", -1, datetime);
+  }
+
+  void loop() {
+    if (file.pending()) {
+      file.write();
+      if (file.endWrite()) {
+        file.close();
+        file.openWave("rec2.wav", -1, datetime);
+      }
+    }
+  }
+*/
+
+#ifndef SDMirrorWriter_h
+#define SDMirrorWriter_h
+
+
+#include <Arduino.h>
+#include <DataWorker.h>
+#include <SDCard.h>
+#include <SDWriter.h>
+
+
+class SDMirrorWriter : public DataWorker {
+
+ public:
+
+  // Number of SD cards that are written to.
+  static const size_t NCards = 2;
+
+  // Initialize writer on SD cards sd0 and sd1.
+  SDMirrorWriter(SDCard &sd0, SDCard &sd1, const DataWorker &data,
+		 int verbose=0);
+
+  // Number of SD cards that are available.
+  size_t cardsAvailable() const;
+
+  // The index-th SD card.
+  SDCard *sdcard(size_t index) { return Writers[index]->sdcard(); };
+
+  // The writer for the index-th SD card.
+  SDWriter &writer(size_t index) { return *Writers[index]; };
+
+  // True if data are currently written to the index-th SD card.
+  // False if the card is not available or it was dropped because
+  // of a write failure or because it could not keep up with the data.
+  bool active(size_t index) const;
+
+  // Return write interval in seconds.
+  float writeInterval() const;
+
+  // Set write interval.
+  // If time is positive it is a time interval in seconds.
+  // If time is negative it is the fraction of the full data buffer.
+  void setWriteInterval(float time=-0.25);
+
+  // True if data are pending that need to be written to files.
+  // Check this regularly in loop() and call write() if true is returned.
+  bool pending();
+
+  // Open new wave files on all available SD cards.
+  // Cards that have been dropped previously are tried again.
+  // See SDWriter::openWave() for details.
+  // Return true if a file was opened on at least one SD card.
+  bool openWave(const char *fname, int64_t samples=-1,
+                const char *datetime=0);
+
+  // True if a file is open on at least one SD card.
+  bool isOpen() const;
+
+  // Close files on all SD cards without updating the wave headers.
+  // Lagging SD cards catch up before.
+  // Use this if the file size was set by openWave().
+  void close();
+
+  // Update wave headers with proper file size and close files.
+  // Lagging SD cards catch up before.
+  // Return true if all files have been sucessfully closed
+  // and hold all the data.
+  bool closeWave();
+
+  // Name of the currently or previously open files.
+  const String &name() const { return Writers[0]->name(); };
+
+  // Write available data to files on all active SD cards.
+  // Return number of samples the leading SD card advanced
+  // or a negative number on error:
+  //  0: no data available yet.
+  // -1: file is not open on any SD card.
+  // -2: files are already full according to maxFileSamples().
+  // -3: no data are available, although there should be some.
+  // -4: overrun.
+  // -5: data were not written to any of the SD cards.
+  ssize_t write();
+
+  // Start writing to files from the current sample minus decr frames on.
+  void start(size_t decr=0);
+
+  // Return current file size of the leading SD card in samples.
+  uint64_t fileSamples() const { return FileSamples; };
+
+  // Return current file size of the leading SD card in seconds.
+  float fileTime() const;
+
+  // Set maximum file size to a fixed number of samples modulo 256.
+  void setMaxFileSamples(uint64_t samples);
+
+  // Allow for wave files larger than 4GB in RF64 format.
+  // See SDWriter::setRF64() for details.
+  void setRF64(bool rf64=true);
+
+  // Set maximum file size to approximately that many seconds.
+  void setMaxFileTime(float secs);
+
+  // Return actually used maximum file size in samples.
+  // Set by openWave() to the smallest limit of the active SD cards,
+  // zero if none of them limits the file size.
+  uint64_t maxFileSamples() const;
+
+  // Return true if maximum number of samples have been written on
+  // all active SD cards and new files need to be opened.
+  bool endWrite();
+
+  // Data buffer has been initialized.
+  virtual void reset();
+
+
+ protected:
+
+  // Number of samples the index-th SD card is behind the leading one.
+  size_t lag(size_t index) const;
+
+  // Write lag samples of the index-th SD card plus nsamples samples
+  // from the data buffer. Return number of written samples or
+  // a negative number on error.
+  ssize_t writeCard(size_t index, size_t nsamples);
+
+  // Write the lagging samples of all active SD cards, such that all
+  // files hold the same data. Return false if a card could not
+  // catch up.
+  bool catchUp();
+
+  // Close file on the index-th SD card and stop writing on it
+  // until the next file is opened.
+  void drop(size_t index, const char *reason);
+
+  SDWriter Writer0;
+  SDWriter Writer1;
+  SDWriter *Writers[NCards];
+  bool Active[NCards];
+
+  elapsedMillis WriteTime;
+  uint32_t WriteInterval;
+
+  uint64_t FileSamples;    // number of samples written by the leading card.
+  uint64_t FileMaxSamples; // maximum number of samples to be stored in a file.
+
+};
+
+
+#endif
@@ -12,6 +12,12 @@ SDWriter::SDWriter() :
   WriteInterval(100),
   FileSamples(0),
   FileMaxSamples(0),
+  RF64(false),
+  UpdateInterval(0),
+  IndexFile(""),
+  FileStart(0),
+  PrevEnd(0),
+  FileMissed(0),
   StartWriteTime(0) {
   DataFile.close();
 }
@@ -27,6 +33,12 @@ SDWriter::SDWriter(const DataWorker &producer, int verbose) :
   WriteInterval(100),
   FileSamples(0),
   FileMaxSamples(0),
+  RF64(false),
+  UpdateInterval(0),
+  IndexFile(""),
+  FileStart(0),
+  PrevEnd(0),
+  FileMissed(0),
   StartWriteTime(0) {
   SDC = new SDCard;
   DataFile.close();
@@ -43,6 +55,12 @@ SDWriter::SDWriter(SDCard &sd, const DataWorker &producer, int verbose) :
   WriteInterval(100),
   FileSamples(0),
   FileMaxSamples(0),
+  RF64(false),
+  UpdateInterval(0),
+  IndexFile(""),
+  FileStart(0),
+  PrevEnd(0),
+  FileMissed(0),
   StartWriteTime(0) {
   DataFile.close();
 }
@@ -139,15 +157,36 @@ bool SDWriter::isOpen() const {
 
 
 void SDWriter::close() {
+  if (! (DataFile))
+    return;
+  if (Wave.markers() > 0 && FileSamples > 0) {
+    // cue chunks need to be appended and included in the wave header:
+    closeWave();
+    return;
+  }
+  if (IndexFile.length() > 0)
+    appendIndex();
   DataFile.close();
 }
 
 
-bool SDWriter::openWave(const char *fname, int32_t samples,
+bool SDWriter::openWave(const char *fname, int64_t samples,
 			const char *datetime) {
   if (!open(fname))
     return false;
   elapsedMillis t = 0;
+  bool rf64 = RF64;
+  if (rf64 && !SDC->isExFAT()) {
+    rf64 = false;
+    if (FileMaxSamples > MaxRIFFSamples) {
+      Serial.printf("WARNING in SDWriter::openWave(): %sSD card is not formatted with exFAT, limit file size to 4GB.\n", sdcard()->name());
+      FileMaxSamples = (MaxRIFFSamples/MajorSize)*MajorSize;
+    }
+  }
+  Wave.setRF64(rf64);
+  Wave.clearMarkers();
+  FileStart = uint64_t(cycle())*nbuffer() + index();
+  FileMissed = 0;
   if (samples < 0)
     samples = FileMaxSamples;
   Wave.setFormat(nchannels(), rate(), resolution(), dataResolution());
@@ -166,6 +205,7 @@ bool SDWriter::openWave(const char *fname, int32_t samples,
     return false;
   }
   checkTiming(t, "openWave", "opening wave file took %lums");
+  UpdateTime = 0;
   return (DataFile) ? true : false;
 }
 
@@ -191,6 +231,7 @@ bool SDWriter::closeWave() {
   bool success = true;
   if (FileSamples > 0) {
     Wave.setData(FileSamples);
+    Wave.writeCues(DataFile);
     Wave.assemble();
     DataFile.seek(0);
     if (DataFile.write(Wave.Buffer, Wave.NBuffer) != Wave.NBuffer) {  // 2ms
@@ -198,12 +239,111 @@ bool SDWriter::closeWave() {
       success = false;
     }
   }
+  Wave.clearMarkers();
   close();
   checkTiming(t, "closeWave", "closing wave file took %lums");
   return success;
 }
 
 
+bool SDWriter::addMarker(const char *label) {
+  if (! (DataFile))
+    return false;
+  uint64_t head = uint64_t(Producer->cycle())*nbuffer() + Producer->index();
+  uint64_t start = uint64_t(cycle())*nbuffer() + index() - FileSamples;
+  return addMarker(uint32_t((head - start)/nchannels()), label);
+}
+
+
+bool SDWriter::addMarker(uint32_t frame, const char *label) {
+  if (! (DataFile))
+    return false;
+  return Wave.addMarker(frame, label);
+}
+
+
+bool SDWriter::updateHeader() {
+  if (! (DataFile))
+    return false;
+  elapsedMillis t = 0;
+  Wave.setData(FileSamples);
+  Wave.assemble();
+  uint64_t pos = DataFile.curPosition();
+  DataFile.seek(0);
+  bool success = (DataFile.write(Wave.Buffer, Wave.NBuffer) == Wave.NBuffer);
+  DataFile.seek(pos);
+  DataFile.sync();
+  if (!success)
+    Serial.printf("ERROR: updating wave header on %sSD card failed.\n", sdcard()->name());
+  checkTiming(t, "updateHeader", "updating wave header took %lums");
+  return success;
+}
+
+
+float SDWriter::headerUpdateInterval() const {
+  return 0.001*UpdateInterval;
+}
+
+
+void SDWriter::setHeaderUpdateInterval(float secs) {
+  UpdateInterval = uint32_t(1000*secs);
+}
+
+
+void SDWriter::checkUpdate() {
+  if (UpdateInterval > 0 && UpdateTime > UpdateInterval) {
+    UpdateTime = 0;
+    updateHeader();
+  }
+}
+
+
+void SDWriter::setIndexFile(const char *fname) {
+  IndexFile = fname;
+  PrevEnd = 0;
+}
+
+
+// print unsigned 64-bit integer into str holding at least 21 characters:
+static void u64Str(char *str, uint64_t val) {
+  char buf[21];
+  int n = 0;
+  do {
+    buf[n++] = '0' + val % 10;
+    val /= 10;
+  } while (val > 0);
+  for (int k=0; k<n; k++)
+    str[k] = buf[n - 1 - k];
+  str[n] = '\0';
+}
+
+
+bool SDWriter::appendIndex() {
+  bool exists = SDC->exists(IndexFile.c_str());
+  FsFile file = SDC->openAppend(IndexFile.c_str());
+  if (!file) {
+    Serial.printf("ERROR: failed to open index file \"%s\" on %sSD card.\n",
+		  IndexFile.c_str(), sdcard()->name());
+    return false;
+  }
+  if (!exists)
+    file.println("file,start,frames,time,missed,gap");
+  uint8_t nchan = nchannels() > 0 ? nchannels() : 1;
+  char starts[21];
+  u64Str(starts, FileStart/nchan);
+  char frames[21];
+  u64Str(frames, FileSamples/nchan);
+  // PrevEnd is zero for the first file of a session:
+  bool gap = (PrevEnd > 0 && FileStart != PrevEnd);
+  file.printf("%s,%s,%s,%s,%lu,%d\n", FileName.c_str(), starts,
+	      frames, Wave.dateTime(),
+	      (unsigned long)FileMissed, gap);
+  file.close();
+  PrevEnd = FileStart + FileSamples + FileMissed;
+  return true;
+}
+
+
 String SDWriter::baseName() const {
   int idx = FileName.lastIndexOf('.');
   if (idx >= 0)
@@ -223,6 +363,7 @@ ssize_t SDWriter::write() {
     return -2;
   size_t missed = overrun();
   if (missed > 0) {
+    FileMissed += missed;
     uint32_t wt = WriteTime;
     Serial.printf("ERROR in SDWriter::write() on %sSD card: data overrun! Missed %d samples (%.0f%% of buffer, %.0fms).\n", sdcard()->name(), missed, 100.0*missed/nbuffer(), 1000*time(missed));
     Serial.printf("------> last write on %sSD card %dms ago.\n", sdcard()->name(), wt);
@@ -247,7 +388,7 @@ ssize_t SDWriter::write() {
   if (Index >= index) {
     nwrite = nbuffer() - Index;
     if (FileMaxSamples > 0 && nwrite > FileMaxSamples - FileSamples)
-      nwrite = FileMaxSamples - FileSamples;
+      nwrite = size_t(FileMaxSamples - FileSamples);
     if (nwrite > 0) {
       nbytes = DataFile.write((void *)&Data->buffer()[Index],
 			      sizeof(sample_t)*nwrite);
@@ -271,7 +412,7 @@ ssize_t SDWriter::write() {
   WriteTime = 0;
   nwrite = index - Index;
   if (FileMaxSamples > 0 && nwrite > FileMaxSamples - FileSamples)
-    nwrite = FileMaxSamples - FileSamples;
+    nwrite = size_t(FileMaxSamples - FileSamples);
   nwrite = (nwrite/MajorSize)*MajorSize;          // write only full blocks
   if (nwrite > 0) {
     nbytes = DataFile.write((void *)&Data->buffer()[Index],
@@ -287,10 +428,36 @@ ssize_t SDWriter::write() {
     FileSamples += samples1;
   }
   checkTiming(WriteTime, "write", "needed %lums for writing beginning-of-buffer data");
+  checkUpdate();
   return samples0 + samples1;
 }
 
 
+ssize_t SDWriter::writeSamples(const volatile sample_t *data,
+				 size_t nsamples) {
+  if (! (DataFile))
+    return -1;
+  if (FileMaxSamples > 0 && FileSamples >= FileMaxSamples)
+    return -2;
+  if (FileMaxSamples > 0 && nsamples > FileMaxSamples - FileSamples)
+    nsamples = size_t(FileMaxSamples - FileSamples);
+  if (nsamples == 0)
+    return 0;
+  elapsedMillis t = 0;
+  size_t nbytes = DataFile.write((void *)data, sizeof(sample_t)*nsamples);
+  if (nbytes == 0)
+    return -5;
+  checkTiming(t, "writeSamples", "needed %lums for writing data");
+  size_t samples = nbytes / sizeof(sample_t);
+  if (Verbose > 0 && samples < nsamples)
+    Serial.printf("WARNING in SDWriter::writeSamples() on %sSD card: only wrote %d samples of %d\n",
+		  sdcard()->name(), samples, nsamples);
+  FileSamples += samples;
+  checkUpdate();
+  return samples;
+}
+
+
 void SDWriter::start(size_t decr) {
   if (!synchronize())
     Serial.println("ERROR in SDWriter::startWrite(): data buffer not initialized yet. ");
@@ -312,7 +479,7 @@ void SDWriter::start(const SDWriter &file) {
 }
 
 
-size_t SDWriter::fileSamples() const {
+uint64_t SDWriter::fileSamples() const {
   return FileSamples;
 }
 
@@ -327,19 +494,29 @@ void SDWriter::fileTimeStr(char *str) const {
 }
 
 
-void SDWriter::setMaxFileSamples(size_t samples) {
+void SDWriter::setMaxFileSamples(uint64_t samples) {
+  if (!RF64 && samples > MaxRIFFSamples) {
+    Serial.println("WARNING in SDWriter::setMaxFileSamples(): file size limited to 4GB. Use setRF64() for larger files.");
+    samples = MaxRIFFSamples;
+  }
   FileMaxSamples = (samples/MajorSize)*MajorSize;
 }
 
 
+void SDWriter::setRF64(bool rf64) {
+  RF64 = rf64;
+}
+
+
 void SDWriter::setMaxFileTime(float secs) {
   if (rate() == 0)
     Serial.println("WARNING in SDWriter::setMaxFileTime(): sampling rate not yet set!");
-  setMaxFileSamples(samples(secs));
+  // in 64 bit, long files easily exceed 2^32 samples:
+  setMaxFileSamples(uint64_t(floor(double(secs)*rate()))*nchannels());
 }
 
 
-size_t SDWriter::maxFileSamples() const {
+uint64_t SDWriter::maxFileSamples() const {
   return FileMaxSamples;
 }
 
@@ -9,6 +9,7 @@
 
 #include <Arduino.h>
 #include <DataWorker.h>
+#include <DataBuffer.h>
 #include <SDCard.h>
 #include <WaveHeader.h>
 
@@ -61,7 +62,10 @@ class SDWriter : public DataWorker {
   // True if file is open.
   bool isOpen() const;
 
-  // Close file.
+  // Close file without updating the size of the data in the wave header.
+  // Appends an entry to the index file, if set by setIndexFile().
+  // If markers have been added, they are written like in closeWave(),
+  // including an update of the wave header with the actual file size.
   void close();
 
   // Return file object.
@@ -75,7 +79,7 @@ class SDWriter : public DataWorker {
   // number of samples there.
   // If no file extension is provided, ".wav" is added.
   // Return true if the file was successfully opened.
-  bool openWave(const char *fname, int32_t samples=-1,
+  bool openWave(const char *fname, int64_t samples=-1,
                 const char *datetime=0);
 
   // Open new file for writing and write wave header from file.
@@ -88,6 +92,31 @@ class SDWriter : public DataWorker {
   // file size.
   bool closeWave();
 
+  // Mark the most recent sample acquired by the producer in the
+  // currently open file with an optional label (max 15 characters).
+  // Markers are stored as cue points with labels when the file is
+  // closed with closeWave() or close(). Use them for events like
+  // button presses, detected signals, or time synchronization pulses.
+  // Return false if no file is open or no more markers can be stored.
+  bool addMarker(const char *label=0);
+
+  // Mark frame (sample index of each channel relative to the beginning
+  // of the currently open file) with an optional label.
+  bool addMarker(uint32_t frame, const char *label);
+
+  // Write the wave header with the current file size and flush the file,
+  // such that the file remains valid on power loss.
+  // Only the first sector of the file is rewritten.
+  // Return true on success.
+  bool updateHeader();
+
+  // Interval in seconds for updating the wave header while writing.
+  float headerUpdateInterval() const;
+
+  // Update the wave header via updateHeader() every secs seconds
+  // from within write(). Set to zero to disable (default).
+  void setHeaderUpdateInterval(float secs);
+
   // Name of the currently or previously open file.
   const String &name() const {return FileName; };
 
@@ -109,6 +138,16 @@ class SDWriter : public DataWorker {
   // -5: data were not written to file (disk full?)
   ssize_t write();
 
+  // Write nsamples samples from data to file, bypassing the cyclic
+  // buffer of the DataWorker. Used by consumers that read the data
+  // buffer themselves, like SDMirrorWriter.
+  // nsamples are truncated to fit into maxFileSamples().
+  // Return number of written samples or a negative number on error:
+  // -1: file is not open.
+  // -2: file is already full according to maxFileSamples().
+  // -5: data were not written to file (disk full?)
+  ssize_t writeSamples(const volatile sample_t *data, size_t nsamples);
+
   // Start writing to a file from the current sample minus decr samples on.
   void start(size_t decr=0);
   
@@ -116,7 +155,7 @@ class SDWriter : public DataWorker {
   void start(const SDWriter &file);
 
   // Return current file size in samples.
-  size_t fileSamples() const;
+  uint64_t fileSamples() const;
 
   // Return current file size in seconds.
   float fileTime() const;
@@ -126,20 +165,49 @@ class SDWriter : public DataWorker {
   void fileTimeStr(char *str) const;
 
   // Set maximum file size to a fixed number of samples modulo 256.
-  void setMaxFileSamples(size_t samples);
+  // Without RF64 (see setRF64()) the number of samples is limited
+  // to the 4GB limit of wave files.
+  void setMaxFileSamples(uint64_t samples);
 
   // Set maximum file size to approximately that many seconds.
   void setMaxFileTime(float secs);
 
   // Return actually used maximum file size in samples.
-  size_t maxFileSamples() const;
+  uint64_t maxFileSamples() const;
 
   // Return maximum file size in seconds.
   float maxFileTime() const;
 
+  // True if wave files larger than 4GB are written in RF64 format.
+  bool rf64() const { return RF64; };
+
+  // Allow for wave files larger than 4GB in RF64 format.
+  // Wave files smaller than 4GB are still written as normal RIFF files.
+  // This requires a SD card formatted with exFAT.
+  // Call this before setMaxFileSamples() or setMaxFileTime().
+  void setRF64(bool rf64=true);
+
   // Return true if maximum number of samples have been written
   // and a new file needs to be opened.
   bool endWrite();
+
+  // Name of the session index file.
+  const String &indexFile() const { return IndexFile; };
+
+  // Append a line for each file closed by close() or closeWave() to the index
+  // file fname (comma separated values) in the current working directory.
+  // Each line holds the file name, the absolute start frame since the
+  // start of the acquisition, the number of frames in the file,
+  // the start time passed to openWave(), the number of samples missed
+  // because of overruns, and a flag that is 1 if the file does not
+  // continue the previous one.
+  // This way, rotated files of a session can be located
+  // by an absolute time without opening them.
+  // Pass an empty string to disable the index (default).
+  void setIndexFile(const char *fname);
+
+  // Number of samples missed because of overruns in the current file.
+  size_t missedSamples() const { return FileMissed; };
   
   // Data buffer has been initialized.
   virtual void reset();
@@ -158,6 +226,12 @@ class SDWriter : public DataWorker {
   // Print error messages about timing issues, depending on verbosity level.
   void checkTiming(uint32_t t, const char *function, const char *message);
 
+  // Call updateHeader() if the header update interval passed.
+  void checkUpdate();
+
+  // Append entry of the current file to the index file.
+  bool appendIndex();
+
   SDCard *SDC;
   bool SDOwn;
   mutable FsFile DataFile;   // mutable because File from FS.h has non-constant bool() function
@@ -169,8 +243,20 @@ class SDWriter : public DataWorker {
   uint32_t MaxWriteTime;
   uint32_t WriteInterval;
 
-  size_t FileSamples;    // current number of samples stored in the file.
-  size_t FileMaxSamples; // maximum number of samples to be stored in a file.
+  uint64_t FileSamples;    // current number of samples stored in the file.
+  uint64_t FileMaxSamples; // maximum number of samples to be stored in a file.
+  bool RF64;             // allow for RF64 files larger than 4GB.
+
+  elapsedMillis UpdateTime;
+  uint32_t UpdateInterval;
+
+  String IndexFile;      // name of the session index file.
+  uint64_t FileStart;    // absolute index of first sample in the file.
+  uint64_t PrevEnd;      // absolute index following the previous file.
+  size_t FileMissed;     // number of samples missed in the current file.
+
+  // Maximum number of samples fitting into a RIFF wave file:
+  static const size_t MaxRIFFSamples = (0xFFFFFFFF - WaveHeader::MaxBuffer)/sizeof(sample_t);
 
   uint32_t StartWriteTime; // time when writing was started in milliseconds.
   
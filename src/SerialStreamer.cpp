@@ -0,0 +1,166 @@
+#include <DataBuffer.h>
+#include <SerialStreamer.h>
+
+
+uint32_t SerialStreamer::CRCTable[256] = {0};
+
+
+SerialStreamer::SerialStreamer(const DataWorker &producer, Print &stream,
+			       size_t nframes, int verbose) :
+  DataWorker(&producer, verbose),
+  Output(stream),
+  NFrames(nframes > 0 ? nframes : 1),
+  MaxLag(0),
+  NLag(0),
+  NChannels(0),
+  Block(0),
+  BlockSize(0),
+  BlockPos(0),
+  Blocks(0),
+  Dropped(0) {
+  if (CRCTable[1] == 0) {
+    for (uint32_t k=0; k<256; k++) {
+      uint32_t c = k;
+      for (int j=0; j<8; j++)
+	c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      CRCTable[k] = c;
+    }
+  }
+}
+
+
+SerialStreamer::~SerialStreamer() {
+  stop();
+}
+
+
+bool SerialStreamer::setBlockFrames(size_t nframes) {
+  if (nframes > MaxFrames) {
+    Serial.printf("ERROR in SerialStreamer::setBlockFrames(): more than %u frames per block are not supported.\n", MaxFrames);
+    return false;
+  }
+  NFrames = nframes > 0 ? nframes : 1;
+  return true;
+}
+
+
+void SerialStreamer::setMaxLag(size_t nframes) {
+  MaxLag = nframes;
+}
+
+
+bool SerialStreamer::start() {
+  stop();
+  if (Producer == 0 || nchannels() == 0) {
+    Serial.println("ERROR in SerialStreamer::start(): no data available.");
+    return false;
+  }
+  if (NFrames > MaxFrames) {
+    Serial.printf("ERROR in SerialStreamer::start(): more than %u frames per block are not supported.\n", MaxFrames);
+    return false;
+  }
+  NChannels = nchannels();
+  size_t nbuffer = this->nbuffer()/NChannels;
+  if (NFrames > nbuffer/2) {
+    Serial.printf("ERROR in SerialStreamer::start(): %u frames per block do not fit twice into the data buffer.\n", NFrames);
+    return false;
+  }
+  BlockSize = HeaderSize + NFrames*NChannels*sizeof(sample_t);
+  Block = (uint8_t *)malloc(BlockSize);
+  if (Block == 0) {
+    Serial.printf("ERROR in SerialStreamer::start(): not enough memory for block of %u bytes.\n", BlockSize);
+    BlockSize = 0;
+    return false;
+  }
+  NLag = MaxLag > 0 ? MaxLag : nbuffer/2;
+  if (NLag < NFrames)
+    NLag = NFrames;
+  BlockPos = BlockSize;
+  Blocks = 0;
+  Dropped = 0;
+  synchronize();
+  return true;
+}
+
+
+void SerialStreamer::stop() {
+  if (Block != 0)
+    free(Block);
+  Block = 0;
+  BlockSize = 0;
+  BlockPos = 0;
+}
+
+
+void SerialStreamer::update() {
+  if (Block == 0)
+    return;
+  while (true) {
+    // write as much of the current block as possible:
+    if (BlockPos < BlockSize) {
+      int n = Output.availableForWrite();
+      if (n <= 0)
+	return;
+      if (size_t(n) > BlockSize - BlockPos)
+	n = BlockSize - BlockPos;
+      BlockPos += Output.write(&Block[BlockPos], n);
+      if (BlockPos < BlockSize)
+	return;
+      Blocks++;
+    }
+    // drop missed data and whole blocks the host could not keep up with:
+    size_t missed = overrun()/NChannels;
+    size_t navail = available()/NChannels;
+    if (navail > NLag) {
+      size_t ndrop = ((navail - NLag + NFrames - 1)/NFrames)*NFrames;
+      increment(ndrop*NChannels);
+      missed += ndrop;
+      navail -= ndrop;
+    }
+    if (missed > 0) {
+      Dropped += missed;
+      if (Verbose > 1)
+	Serial.printf("WARNING in SerialStreamer::update(): dropped %u frames.\n", missed);
+    }
+    if (navail < NFrames)
+      return;
+    prepareBlock();
+  }
+}
+
+
+void SerialStreamer::prepareBlock() {
+  uint64_t index = ((uint64_t)Cycle*nbuffer() + Index)/NChannels;
+  uint32_t rate = this->rate();
+  uint16_t nframes = NFrames;
+  memcpy(&Block[0], "TRSB", 4);
+  Block[4] = 1;
+  Block[5] = NChannels;
+  memcpy(&Block[6], &nframes, 2);
+  memcpy(&Block[8], &rate, 4);
+  memcpy(&Block[12], &Dropped, 4);
+  memcpy(&Block[16], &index, 8);
+  // copy data, wrapping around the end of the data buffer:
+  size_t nsamples = NFrames*NChannels;
+  size_t n = nbuffer() - Index;
+  if (n > nsamples)
+    n = nsamples;
+  sample_t *data = (sample_t *)&Block[HeaderSize];
+  memcpy(data, (const sample_t *)&Data->buffer()[Index], n*sizeof(sample_t));
+  if (n < nsamples)
+    memcpy(&data[n], (const sample_t *)Data->buffer(),
+	   (nsamples - n)*sizeof(sample_t));
+  increment(nsamples);
+  uint32_t crc = crc32(0xffffffff, Block, 24);
+  crc = crc32(crc, (const uint8_t *)data, nsamples*sizeof(sample_t));
+  crc ^= 0xffffffff;
+  memcpy(&Block[24], &crc, 4);
+  BlockPos = 0;
+}
+
+
+uint32_t SerialStreamer::crc32(uint32_t crc, const uint8_t *data, size_t n) {
+  for (size_t k=0; k<n; k++)
+    crc = CRCTable[(crc ^ data[k]) & 0xff] ^ (crc >> 8);
+  return crc;
+}
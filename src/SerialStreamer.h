@@ -0,0 +1,128 @@
+/*
+  SerialStreamer - Stream data as framed binary blocks over USB serial.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+/*
+  Each block consists of a header of HeaderSize bytes followed by the
+  data of nframes frames of all channels as multiplexed 16-bit
+  integers. All values are little endian:
+
+  offset  type      content
+  0       char[4]   "TRSB"
+  4       uint8     format version (1)
+  5       uint8     number of channels
+  6       uint16    number of frames in the block
+  8       uint32    sampling rate in Hertz
+  12      uint32    total number of frames dropped so far
+  16      uint64    index of the first frame of the block
+  24      uint32    CRC-32 of bytes 0-23 and of the data
+
+  The CRC-32 is the one of zlib, Ethernet, and PNG.
+
+  Blocks are written only as fast as the stream accepts them
+  (availableForWrite()), so update() never blocks. If the host reads
+  too slowly, the oldest whole blocks are dropped. The frame index
+  and the number of dropped frames in the header allow the host to
+  detect these gaps.
+
+  Do not print anything else on the stream while streaming.
+  See utils/streamreader.py for reading the blocks on the host.
+
+  Usage:
+
+  SerialStreamer streamer(aidata);
+  ...
+  aidata.start();
+  streamer.start();
+  ...
+  void loop() {
+    streamer.update();
+  }
+*/
+
+#ifndef SerialStreamer_h
+#define SerialStreamer_h
+
+
+#include <Arduino.h>
+#include <DataWorker.h>
+
+
+class SerialStreamer : public DataWorker {
+
+ public:
+
+  // Size of the block header in bytes.
+  static const size_t HeaderSize = 28;
+
+  // Maximum number of frames per block that fit into the header.
+  static const size_t MaxFrames = 0xFFFF;
+
+  // Stream data of producer in blocks of nframes frames on stream.
+  SerialStreamer(const DataWorker &producer, Print &stream=Serial,
+		 size_t nframes=256, int verbose=0);
+  ~SerialStreamer();
+
+  // Number of frames per block.
+  size_t blockFrames() const { return NFrames; };
+
+  // Set number of frames per block (at most MaxFrames).
+  // Takes effect at the next call of start().
+  // Return false if nframes is too large.
+  bool setBlockFrames(size_t nframes);
+
+  // Maximum number of frames streaming may lag behind the producer.
+  // If exceeded, the oldest blocks are dropped.
+  size_t maxLag() const { return MaxLag; };
+
+  // Set maximum number of frames streaming may lag behind the producer.
+  // Zero (default) sets it to half the data buffer at start().
+  void setMaxLag(size_t nframes);
+
+  // Allocate block buffer and start streaming from the current
+  // position of the producer.
+  // Return false if not enough memory is available.
+  bool start();
+
+  // Stop streaming and free block buffer.
+  void stop();
+
+  // Number of blocks completely written so far.
+  uint32_t blocks() const { return Blocks; };
+
+  // Number of frames dropped so far.
+  uint32_t dropped() const { return Dropped; };
+
+  // Write as much data as the stream accepts without blocking.
+  // Call this as often as possible in loop().
+  void update();
+
+
+ protected:
+
+  // Fill the block buffer with header and the next nframes frames.
+  void prepareBlock();
+
+  // Update crc with n bytes of data.
+  static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t n);
+
+  Print &Output;
+  size_t NFrames;
+  size_t MaxLag;
+  size_t NLag;
+  uint8_t NChannels;
+
+  uint8_t *Block;       // header and data of current block.
+  size_t BlockSize;     // number of bytes of current block.
+  size_t BlockPos;      // number of bytes already written.
+
+  uint32_t Blocks;
+  uint32_t Dropped;
+
+  static uint32_t CRCTable[256];
+
+};
+
+
+#endif
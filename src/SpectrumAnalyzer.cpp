@@ -0,0 +1,340 @@
+#include <SpectrumAnalyzer.h>
+
+
+SpectrumAnalyzer::SpectrumAnalyzer(AnalysisChain *chain, size_t nfft) :
+  Analyzer(chain),
+  NFFT(256),
+  Window(HANN),
+  Overlap(0.5),
+  Averages(1),
+  NBands(0),
+  NChannels(0),
+  CChannel(0),
+  NWindows(0),
+  NSegments(0),
+  Counter(0),
+  Memory(0),
+  WindowBuffer(0),
+  Cos(0),
+  Sin(0),
+  FFTRe(0),
+  FFTIm(0),
+  Accu(0),
+  Power(0),
+  BandPowers(0),
+  WindowNorm(1) {
+  ReadOnly = true;
+  setNFFT(nfft);
+}
+
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+  stop();
+}
+
+
+void SpectrumAnalyzer::setNFFT(size_t nfft) {
+  NFFT = 4;
+  while (2*NFFT <= nfft)
+    NFFT *= 2;
+}
+
+
+void SpectrumAnalyzer::setWindow(WINDOW window) {
+  Window = window;
+}
+
+
+void SpectrumAnalyzer::setOverlap(float overlap) {
+  if (overlap < 0.0)
+    overlap = 0.0;
+  if (overlap > 0.9)
+    overlap = 0.9;
+  Overlap = overlap;
+}
+
+
+void SpectrumAnalyzer::setAverages(uint16_t averages) {
+  Averages = averages > 0 ? averages : 1;
+}
+
+
+int SpectrumAnalyzer::addBand(float flow, float fhigh) {
+  if (NBands >= MaxBands)
+    return -1;
+  BandLow[NBands] = flow;
+  BandHigh[NBands] = fhigh;
+  return NBands++;
+}
+
+
+void SpectrumAnalyzer::clearBands() {
+  NBands = 0;
+}
+
+
+float SpectrumAnalyzer::deltaFrequency() const {
+  return Rate/NFFT;
+}
+
+
+const float *SpectrumAnalyzer::spectrum(uint8_t channel) const {
+  if (Power == 0 || channel >= NChannels || Counter == 0)
+    return 0;
+  return &Power[channel*frequencies()];
+}
+
+
+float SpectrumAnalyzer::bandPower(uint8_t channel, uint8_t band) const {
+  if (BandPowers == 0 || channel >= NChannels || band >= NBands)
+    return 0.0;
+  return BandPowers[channel*MaxBands + band];
+}
+
+
+float SpectrumAnalyzer::bandPowerDB(uint8_t channel, uint8_t band) const {
+  float p = bandPower(channel, band);
+  if (p <= 1e-20)
+    return -200.0;
+  return 10.0*log10(p);
+}
+
+
+void SpectrumAnalyzer::writeBands(Print &stream, bool header) const {
+  for (uint8_t c=0; c<NChannels; c++) {
+    for (uint8_t b=0; b<NBands; b++) {
+      if (c > 0 || b > 0)
+	stream.print(',');
+      if (header)
+	stream.printf("ch%u-%.0f-%.0fHz", c, BandLow[b], BandHigh[b]);
+      else
+	stream.printf("%.1f", bandPowerDB(c, b));
+    }
+  }
+  stream.println();
+}
+
+
+void SpectrumAnalyzer::writeSpectrum(Print &stream, uint8_t channel) const {
+  const float *power = spectrum(channel);
+  if (power == 0)
+    return;
+  for (size_t k=0; k<frequencies(); k++) {
+    float p = power[k] > 1e-20 ? 10.0*log10(power[k]) : -200.0;
+    stream.printf("%8.1f %7.1f\n", frequency(k), p);
+  }
+}
+
+
+void SpectrumAnalyzer::start(uint8_t nchannels, size_t nframes) {
+  stop();
+  if (nframes < 4) {
+    Serial.println("ERROR in SpectrumAnalyzer::start(): analysis window too short.");
+    return;
+  }
+  if (NFFT > nframes) {
+    size_t nfft = NFFT;
+    setNFFT(nframes);
+    Serial.printf("WARNING in SpectrumAnalyzer::start(): reduced nfft from %u to %u to fit into analysis window.\n", nfft, NFFT);
+  }
+  NChannels = nchannels;
+  size_t nfreqs = frequencies();
+  size_t n = 4*NFFT + 2*NChannels*nfreqs + NChannels*MaxBands;
+  Memory = (float *)calloc(n, sizeof(float));
+  if (Memory == 0) {
+    Serial.printf("ERROR in SpectrumAnalyzer::start(): not enough memory for %u channels with nfft=%u.\n", NChannels, NFFT);
+    NChannels = 0;
+    return;
+  }
+  WindowBuffer = Memory;
+  Cos = WindowBuffer + NFFT;
+  Sin = Cos + NFFT/2;
+  FFTRe = Sin + NFFT/2;
+  FFTIm = FFTRe + NFFT;
+  Accu = FFTIm + NFFT;
+  Power = Accu + NChannels*nfreqs;
+  BandPowers = Power + NChannels*nfreqs;
+  for (size_t k=0; k<NFFT/2; k++) {
+    Cos[k] = cos(2.0*PI*k/NFFT);
+    Sin[k] = sin(2.0*PI*k/NFFT);
+  }
+  WindowNorm = 0.0;
+  for (size_t k=0; k<NFFT; k++) {
+    float x = 2.0*PI*k/NFFT;
+    float w = 1.0;
+    switch (Window) {
+    case HANN:
+      w = 0.5 - 0.5*cos(x);
+      break;
+    case HAMMING:
+      w = 0.54 - 0.46*cos(x);
+      break;
+    case BLACKMAN:
+      w = 0.42 - 0.5*cos(x) + 0.08*cos(2.0*x);
+      break;
+    default:
+      break;
+    }
+    WindowBuffer[k] = w;
+    WindowNorm += w*w;
+  }
+  CChannel = 0;
+  NWindows = 0;
+  NSegments = 0;
+  Counter = 0;
+}
+
+
+void SpectrumAnalyzer::stop() {
+  if (Memory != 0)
+    free(Memory);
+  Memory = 0;
+  WindowBuffer = 0;
+  Cos = 0;
+  Sin = 0;
+  FFTRe = 0;
+  FFTIm = 0;
+  Accu = 0;
+  Power = 0;
+  BandPowers = 0;
+  NChannels = 0;
+}
+
+
+void SpectrumAnalyzer::analyze(const DataView &data) {
+  if (Memory == 0 || data.frames() < NFFT)
+    return;
+  uint8_t nchannels = NChannels < data.channels() ? NChannels : data.channels();
+  uint32_t t0 = micros();
+  while (CChannel < nchannels) {
+    analyzeChannel(data, CChannel++);
+    if (CChannel < nchannels && budget() > 0 && micros() - t0 >= budget()) {
+      resume();
+      return;
+    }
+  }
+  CChannel = 0;
+  size_t step = NFFT - size_t(Overlap*NFFT);
+  if (step < 1)
+    step = 1;
+  NSegments += (data.frames() - NFFT)/step + 1;
+  NWindows++;
+  if (NWindows < Averages)
+    return;
+  // power spectral densities:
+  size_t nfreqs = frequencies();
+  float norm = 1.0/(NSegments*Rate*WindowNorm);
+  for (uint8_t c=0; c<nchannels; c++) {
+    float *accu = &Accu[c*nfreqs];
+    float *power = &Power[c*nfreqs];
+    for (size_t k=0; k<nfreqs; k++) {
+      power[k] = norm*accu[k];
+      if (k > 0 && k < nfreqs - 1)
+	power[k] *= 2.0;
+      accu[k] = 0.0;
+    }
+    computeBands(c);
+  }
+  NWindows = 0;
+  NSegments = 0;
+  Counter++;
+}
+
+
+void SpectrumAnalyzer::analyzeChannel(const DataView &data, uint8_t channel) {
+  size_t step = NFFT - size_t(Overlap*NFFT);
+  if (step < 1)
+    step = 1;
+  size_t nsegments = (data.frames() - NFFT)/step + 1;
+  float *accu = &Accu[channel*frequencies()];
+  for (size_t s=0; s<nsegments; s += 2) {
+    // transform two real segments with a single complex FFT:
+    loadSegment(data, channel, s*step, FFTRe);
+    if (s + 1 < nsegments)
+      loadSegment(data, channel, (s + 1)*step, FFTIm);
+    else
+      memset(FFTIm, 0, NFFT*sizeof(float));
+    fft();
+    for (size_t k=0; k<=NFFT/2; k++) {
+      size_t j = (NFFT - k) & (NFFT - 1);
+      float xr = FFTRe[k] + FFTRe[j];
+      float xi = FFTIm[k] - FFTIm[j];
+      float yr = FFTIm[k] + FFTIm[j];
+      float yi = FFTRe[k] - FFTRe[j];
+      accu[k] += 0.25*(xr*xr + xi*xi + yr*yr + yi*yi);
+    }
+  }
+}
+
+
+void SpectrumAnalyzer::loadSegment(const DataView &data, uint8_t channel,
+				   size_t frame, float *buffer) {
+  size_t k = 0;
+  while (k < NFFT) {
+    size_t n = data.contiguous(frame + k);
+    if (n == 0) {
+      // frame straddles the end of the buffer:
+      buffer[k] = Scale*WindowBuffer[k]*data.at(channel, frame + k);
+      k++;
+      continue;
+    }
+    if (n > NFFT - k)
+      n = NFFT - k;
+    const volatile sample_t *sp = data.pointer(channel, frame + k);
+    for (size_t i=0; i<n; i++, sp += data.stride(), k++)
+      buffer[k] = Scale*WindowBuffer[k]*(*sp);
+  }
+}
+
+
+void SpectrumAnalyzer::fft() {
+  // bit reversal:
+  for (size_t i=1, j=0; i<NFFT; i++) {
+    size_t bit = NFFT >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      float t = FFTRe[i];
+      FFTRe[i] = FFTRe[j];
+      FFTRe[j] = t;
+      t = FFTIm[i];
+      FFTIm[i] = FFTIm[j];
+      FFTIm[j] = t;
+    }
+  }
+  // butterflies:
+  for (size_t size=2; size<=NFFT; size *= 2) {
+    size_t half = size/2;
+    size_t tstep = NFFT/size;
+    for (size_t i=0; i<NFFT; i += size) {
+      for (size_t k=0; k<half; k++) {
+	float wr = Cos[k*tstep];
+	float wi = -Sin[k*tstep];
+	size_t a = i + k;
+	size_t b = a + half;
+	float tr = wr*FFTRe[b] - wi*FFTIm[b];
+	float ti = wr*FFTIm[b] + wi*FFTRe[b];
+	FFTRe[b] = FFTRe[a] - tr;
+	FFTIm[b] = FFTIm[a] - ti;
+	FFTRe[a] += tr;
+	FFTIm[a] += ti;
+      }
+    }
+  }
+}
+
+
+void SpectrumAnalyzer::computeBands(uint8_t channel) {
+  const float *power = &Power[channel*frequencies()];
+  float df = deltaFrequency();
+  for (uint8_t b=0; b<NBands; b++) {
+    float p = 0.0;
+    for (size_t k=0; k<frequencies(); k++) {
+      float f = k*df;
+      if (f >= BandLow[b] && f < BandHigh[b])
+	p += power[k];
+    }
+    BandPowers[channel*MaxBands + b] = p*df;
+  }
+}
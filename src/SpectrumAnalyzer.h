@@ -0,0 +1,173 @@
+/*
+  SpectrumAnalyzer - Power spectra and band powers of all channels.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+/*
+  Power spectral densities are estimated with Welch's method:
+  each analysis window is split into overlapping segments of nfft
+  frames, each segment is multiplied with a window function and
+  Fourier transformed. The resulting power spectra are averaged over
+  all segments of averages() successive analysis windows.
+
+  Power spectral densities are relative to the full range of the
+  data, i.e. a sine wave with full amplitude has a power of 0.5 or -3dB.
+  Two segments are transformed at once with a single complex FFT.
+*/
+
+#ifndef SpectrumAnalyzer_h
+#define SpectrumAnalyzer_h
+
+
+#include <Analyzer.h>
+
+
+class SpectrumAnalyzer : public Analyzer {
+
+ public:
+
+  enum WINDOW {
+    RECTANGLE,
+    HANN,
+    HAMMING,
+    BLACKMAN
+  };
+
+  // Construct spectrum analyzer with nfft frames per segment
+  // (must be a power of two) and add it to an AnalysisChain.
+  SpectrumAnalyzer(AnalysisChain *chain=0, size_t nfft=256);
+  ~SpectrumAnalyzer();
+
+  // Number of frames of each segment. Power spectra have nfft/2+1
+  // frequencies.
+  size_t nfft() const { return NFFT; };
+
+  // Set number of frames of each segment.
+  // nfft is rounded down to a power of two.
+  // Takes effect at the next call of start().
+  void setNFFT(size_t nfft);
+
+  // Window function applied to each segment.
+  WINDOW window() const { return Window; };
+
+  // Set window function applied to each segment.
+  // Takes effect at the next call of start().
+  void setWindow(WINDOW window);
+
+  // Overlap of successive segments as fraction of nfft.
+  float overlap() const { return Overlap; };
+
+  // Set overlap of successive segments as fraction of nfft
+  // (between 0 and 0.9, default 0.5).
+  void setOverlap(float overlap);
+
+  // Number of analysis windows averaged into a power spectrum.
+  uint16_t averages() const { return Averages; };
+
+  // Set number of analysis windows averaged into a power spectrum
+  // (at least 1).
+  void setAverages(uint16_t averages);
+
+  // Add a frequency band from flow to fhigh Hertz for computing
+  // band powers. Return index of the band, or -1 if there are
+  // already too many bands.
+  int addBand(float flow, float fhigh);
+
+  // Remove all frequency bands.
+  void clearBands();
+
+  // Number of frequency bands.
+  uint8_t bands() const { return NBands; };
+
+  // Number of channels analyzed.
+  uint8_t channels() const { return NChannels; };
+
+  // Number of frequencies of the power spectra.
+  size_t frequencies() const { return NFFT/2 + 1; };
+
+  // Frequency resolution of the power spectra in Hertz.
+  float deltaFrequency() const;
+
+  // Frequency in Hertz of spectral index k.
+  float frequency(size_t k) const { return k*deltaFrequency(); };
+
+  // Number of power spectra computed so far.
+  // Use this for checking whether there is a new power spectrum.
+  uint32_t counter() const { return Counter; };
+
+  // The most recent power spectral density of channel.
+  // Array with frequencies() elements, 0 if not available.
+  const float *spectrum(uint8_t channel) const;
+
+  // Power of band in channel of the most recent power spectrum.
+  float bandPower(uint8_t channel, uint8_t band) const;
+
+  // Power of band in channel of the most recent power spectrum in decibel.
+  float bandPowerDB(uint8_t channel, uint8_t band) const;
+
+  // Write band powers of all channels in decibel as a single line
+  // of comma separated values to stream, one entry per channel and band.
+  // If header, write the column names, channel and band frequencies, instead.
+  void writeBands(Print &stream, bool header=false) const;
+
+  // Write the most recent power spectrum of channel in decibel
+  // as two columns (frequency and power) to stream.
+  void writeSpectrum(Print &stream, uint8_t channel) const;
+
+  // Allocate memory and initialize FFT.
+  virtual void start(uint8_t nchannels, size_t nframes);
+
+  // Free memory.
+  virtual void stop();
+
+  // Accumulate power spectra of all channels of data.
+  // If a time budget is set, channels are processed in chunks.
+  virtual void analyze(const DataView &data);
+
+
+ protected:
+
+  // Accumulate the power spectrum of channel of data.
+  void analyzeChannel(const DataView &data, uint8_t channel);
+
+  // Copy segment of channel starting at frame into buffer and apply window.
+  void loadSegment(const DataView &data, uint8_t channel, size_t frame,
+		   float *buffer);
+
+  // In-place complex FFT of FFTRe and FFTIm.
+  void fft();
+
+  // Compute band powers from the power spectrum of channel.
+  void computeBands(uint8_t channel);
+
+  size_t NFFT;
+  WINDOW Window;
+  float Overlap;
+  uint16_t Averages;
+
+  static const uint8_t MaxBands = 8;
+  uint8_t NBands;
+  float BandLow[MaxBands];
+  float BandHigh[MaxBands];
+
+  uint8_t NChannels;
+  uint8_t CChannel;     // next channel to be analyzed.
+  uint16_t NWindows;    // number of windows accumulated.
+  uint32_t NSegments;   // number of segments accumulated per channel.
+  uint32_t Counter;
+
+  float *Memory;        // all buffers below.
+  float *WindowBuffer;  // window function, NFFT.
+  float *Cos;           // twiddle factors, NFFT/2.
+  float *Sin;           // twiddle factors, NFFT/2.
+  float *FFTRe;         // real part of FFT, NFFT.
+  float *FFTIm;         // imaginary part of FFT, NFFT.
+  float *Accu;          // accumulated power, NChannels*(NFFT/2+1).
+  float *Power;         // power spectral densities, NChannels*(NFFT/2+1).
+  float *BandPowers;    // band powers, NChannels*MaxBands.
+  float WindowNorm;     // sum of squared window values.
+
+};
+
+
+#endif
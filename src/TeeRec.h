@@ -4,11 +4,20 @@
 #include <Input.h>
 #include <InputADC.h>
 #include <InputTDM.h>
+#include <RegisterCache.h>
 #include <ControlPCM186x.h>
+#include <CodecGroup.h>
+#include <SerialStreamer.h>
 
 #include <WaveHeader.h>
 #include <SDCard.h>
 #include <SDWriter.h>
+#include <SDMirrorWriter.h>
+#include <Detector.h>
+#include <ThresholdDetector.h>
+#include <RMSDetector.h>
+#include <BandEnergyDetector.h>
+#include <SDEventWriter.h>
 
 #include <Settings.h>
 #include <InputADCSettings.h>
@@ -21,14 +30,19 @@
 
 #include <TestSignals.h>
 
+#include <Resampler.h>
 #include <AudioPlayBuffer.h>
 #include <AudioMonitor.h>
 
+#include <DataView.h>
 #include <Analyzer.h>
 #include <AnalysisChain.h>
+#include <SpectrumAnalyzer.h>
+#include <LevelAnalyzer.h>
 
 #include <Blink.h>
 #include <Display.h>
+#include <MinMaxPyramid.h>
 #include <PushButtons.h>
 #include <DeviceID.h>
 #include <Menu.h>
@@ -0,0 +1,38 @@
+#include <ThresholdDetector.h>
+
+
+ThresholdDetector::ThresholdDetector(float threshold) :
+  Detector() {
+  setThreshold(threshold);
+}
+
+
+float ThresholdDetector::threshold() const {
+  return Threshold;
+}
+
+
+void ThresholdDetector::setThreshold(float threshold) {
+  Threshold = threshold;
+  Level = int32_t(Threshold/Scale);
+}
+
+
+void ThresholdDetector::start(uint8_t nchannels, float rate,
+			      uint8_t dataresolution) {
+  Detector::start(nchannels, rate, dataresolution);
+  Level = int32_t(Threshold/Scale);
+}
+
+
+ssize_t ThresholdDetector::detect(const volatile sample_t *data,
+				  size_t nsamples) {
+  for (size_t k=0; k<nsamples; k++) {
+    if (selected() && abs(int32_t(data[k])) >= Level) {
+      CChannel = (CChannel + nsamples - k) % NChannels;
+      return k;
+    }
+    nextChannel();
+  }
+  return -1;
+}
@@ -0,0 +1,45 @@
+/*
+  ThresholdDetector - Detect events by thresholding the absolute signal.
+  Created by Jan Benda, October 19th, 2026.
+*/
+
+#ifndef ThresholdDetector_h
+#define ThresholdDetector_h
+
+
+#include <Detector.h>
+
+
+class ThresholdDetector : public Detector {
+
+ public:
+
+  // Construct detector with a threshold relative to the full range
+  // of the data (between 0 and 1).
+  ThresholdDetector(float threshold=0.5);
+
+  // The threshold relative to the full range of the data.
+  float threshold() const;
+
+  // Set the threshold relative to the full range of the data
+  // (between 0 and 1).
+  void setThreshold(float threshold);
+
+  // Convert the threshold to the resolution of the data.
+  virtual void start(uint8_t nchannels, float rate,
+		     uint8_t dataresolution=16);
+
+  // Return the index of the first sample whose absolute value
+  // is equal to or exceeds the threshold, or -1.
+  virtual ssize_t detect(const volatile sample_t *data, size_t nsamples);
+
+
+ protected:
+
+  float Threshold;
+  int32_t Level;     // threshold in units of the samples.
+
+};
+
+
+#endif
@@ -4,6 +4,7 @@
 
 WaveHeader::WaveHeader() :
   Riff("RIFF", "WAVE"),
+  DS64(),
   Format(),
   Info("LIST", "INFO"),
   Bits("BITS", "16"),
@@ -21,7 +22,11 @@ WaveHeader::WaveHeader() :
   Software("ISFT", "TeeRec"),
   Data() {
   DataResolution = 16;
+  UseRF64 = false;
   NBuffer = 0;
+  NChunks = 0;
+  NMarkers = 0;
+  CueBytes = 0;
   setCPUSpeed();  
 }
 
@@ -36,6 +41,9 @@ WaveHeader::Chunk::Chunk(const char *id, uint32_t size) {
   NBuffer = sizeof(Header) + Header.Size;
   Buffer = (char *)&Header;
   Use = true;
+  Modified = true;
+  Offset = 0;
+  LayoutSize = 0;
 }
 
 
@@ -71,24 +79,34 @@ WaveHeader::FormatChunk::FormatChunk(uint8_t nchannels, uint32_t samplerate,
 void WaveHeader::FormatChunk::set(uint8_t nchannels, uint32_t samplerate,
 			          uint16_t resolution) {
   size_t nbytes = (resolution-1)/8  + 1;  // bytes per sample
-  Format.formatTag = 1;                   // 1 is PCM
-  Format.numChannels = nchannels;
-  Format.sampleRate = samplerate;
-  Format.byteRate = samplerate * nchannels * nbytes;
-  Format.blockAlign = nchannels * nbytes;
-  Format.bitsPerSample = nbytes*8;
+  Format_t format;
+  format.formatTag = 1;                   // 1 is PCM
+  format.numChannels = nchannels;
+  format.sampleRate = samplerate;
+  format.byteRate = samplerate * nchannels * nbytes;
+  format.blockAlign = nchannels * nbytes;
+  format.bitsPerSample = nbytes*8;
+  if (memcmp(&format, &Format, sizeof(Format)) != 0) {
+    Format = format;
+    Modified = true;
+  }
 }
 
 
 template <size_t N>
 WaveHeader::InfoChunk<N>::InfoChunk(const char *infoid, const char *text) :
   Chunk(infoid, 0) {
+  Text[0] = '\0';
   set(text);
 }
 
 
 template <size_t N>
 void WaveHeader::InfoChunk<N>::set(const char *text) {
+  if (!Modified && Use == (text[0] != '\0') &&
+      strncmp(Text, text, MaxText - 1) == 0)
+    return;
+  Modified = true;
   if (strlen(text) >= MaxText)
     Serial.printf("ERROR in WaveHeader::InfoChunk(): string \"%s\" of len %d exceeds buffer size of %d!\n", text, strlen(text), MaxText);
   setSize(strlen(text));
@@ -101,25 +119,58 @@ void WaveHeader::InfoChunk<N>::set(const char *text) {
 
 template <size_t N>
 void WaveHeader::InfoChunk<N>::clear() {
+  if (Use)
+    Modified = true;
   setSize(0);
+  Text[0] = '\0';
   Use = false;
 }
 
 
+WaveHeader::DS64Chunk::DS64Chunk() :
+  Chunk("JUNK", sizeof(DS64)) {
+  clear();
+}
+
+
+void WaveHeader::DS64Chunk::set(uint64_t riffsize, uint64_t datasize,
+				uint64_t samplecount) {
+  memcpy(Header.Id, "ds64", 4);
+  DS64.riffSizeLow = riffsize & 0xFFFFFFFF;
+  DS64.riffSizeHigh = riffsize >> 32;
+  DS64.dataSizeLow = datasize & 0xFFFFFFFF;
+  DS64.dataSizeHigh = datasize >> 32;
+  DS64.sampleCountLow = samplecount & 0xFFFFFFFF;
+  DS64.sampleCountHigh = samplecount >> 32;
+  DS64.tableLength = 0;
+}
+
+
+void WaveHeader::DS64Chunk::clear() {
+  memcpy(Header.Id, "JUNK", 4);
+  memset(&DS64, 0, sizeof(DS64));
+}
+
+
 WaveHeader::DataChunk::DataChunk() :
-  Chunk("data", 0) {
+  Chunk("data", 0),
+  Bytes(0) {
 }
 
 
-WaveHeader::DataChunk::DataChunk(uint16_t resolution, int32_t samples) :
+WaveHeader::DataChunk::DataChunk(uint16_t resolution, int64_t samples) :
   Chunk("data", 0) {
   set(resolution, samples);
 }
 
 
-void WaveHeader::DataChunk::set(uint16_t resolution, int32_t samples) {
+void WaveHeader::DataChunk::set(uint16_t resolution, int64_t samples) {
   size_t nbytes = (resolution-1)/8  + 1;  // bytes per sample
-  Header.Size = samples * nbytes;         // in bytes, nchannels is already in samples
+  Bytes = samples * nbytes;               // in bytes, nchannels is already in samples
+  if (Bytes > 0xFFFFFFFF)
+    Header.Size = 0xFFFFFFFF;
+  else
+    Header.Size = Bytes;
 }
 
 
@@ -134,7 +185,11 @@ void WaveHeader::setFormat(uint8_t nchannels, uint32_t samplerate,
   snprintf(bs, 6, "%u", dataresolution);
   bs[3] = '\0';
   DataBits.set(bs);
-  DataBits.Use = (dataresolution != Format.Format.bitsPerSample);
+  bool use = (dataresolution != Format.Format.bitsPerSample);
+  if (use != DataBits.Use) {
+    DataBits.Use = use;
+    DataBits.Modified = true;
+  }
 }
 
 
@@ -171,11 +226,22 @@ void WaveHeader::setGain(const char *gain) {
 }
 
 
-void WaveHeader::setData(int32_t samples) {
+void WaveHeader::setData(int64_t samples) {
   Data.set(DataResolution, samples);
 }
 
 
+void WaveHeader::setRF64(bool rf64) {
+  UseRF64 = rf64;
+}
+
+
+bool WaveHeader::isRF64() const {
+  // header is less than MaxBuffer bytes:
+  return UseRF64 && (Data.Bytes + MaxBuffer > 0xFFFFFFFF);
+}
+
+
 void WaveHeader::setDateTime(const char *datetime) {
   DateTime.set(datetime);
 }
@@ -204,14 +270,279 @@ void WaveHeader::setCPUSpeed() {
 }
 
 
+bool WaveHeader::addMarker(uint32_t frame, const char *label) {
+  if (NMarkers >= MaxMarkers)
+    return false;
+  Markers[NMarkers].Frame = frame;
+  Markers[NMarkers].Label[0] = '\0';
+  if (label != 0) {
+    strncpy(Markers[NMarkers].Label, label, MaxLabel);
+    Markers[NMarkers].Label[MaxLabel - 1] = '\0';
+  }
+  NMarkers++;
+  return true;
+}
+
+
+void WaveHeader::clearMarkers() {
+  NMarkers = 0;
+  CueBytes = 0;
+}
+
+
+size_t WaveHeader::writeCues(Print &stream) {
+  CueBytes = 0;
+  uint64_t frames = 0;
+  if (Format.Format.blockAlign > 0)
+    frames = Data.Bytes/Format.Format.blockAlign;
+  size_t nmarkers = 0;
+  for (size_t k=0; k<NMarkers; k++) {
+    if (Markers[k].Frame <= frames)
+      nmarkers++;
+  }
+  if (nmarkers == 0)
+    return 0;
+  // cue chunk:
+  ChunkHead head;
+  memcpy(head.Id, "cue ", 4);
+  head.Size = 4 + 24*nmarkers;
+  CueBytes += stream.write((uint8_t *)&head, sizeof(head));
+  uint32_t n = nmarkers;
+  CueBytes += stream.write((uint8_t *)&n, sizeof(n));
+  uint32_t id = 0;
+  for (size_t k=0; k<NMarkers; k++) {
+    if (Markers[k].Frame > frames)
+      continue;
+    id++;
+    uint32_t cue[6] = {id, Markers[k].Frame, 0, 0, 0, Markers[k].Frame};
+    memcpy(&cue[2], "data", 4);
+    CueBytes += stream.write((uint8_t *)cue, sizeof(cue));
+  }
+  // adtl list with labels:
+  memcpy(head.Id, "LIST", 4);
+  head.Size = 4;
+  for (size_t k=0; k<NMarkers; k++) {
+    if (Markers[k].Frame <= frames)
+      head.Size += sizeof(head) + 4 + (((strlen(Markers[k].Label) + 2) >> 1) << 1);
+  }
+  CueBytes += stream.write((uint8_t *)&head, sizeof(head));
+  CueBytes += stream.write((const uint8_t *)"adtl", 4);
+  id = 0;
+  for (size_t k=0; k<NMarkers; k++) {
+    if (Markers[k].Frame > frames)
+      continue;
+    id++;
+    size_t nlabel = ((strlen(Markers[k].Label) + 2) >> 1) << 1;
+    memcpy(head.Id, "labl", 4);
+    head.Size = 4 + nlabel;
+    CueBytes += stream.write((uint8_t *)&head, sizeof(head));
+    CueBytes += stream.write((uint8_t *)&id, sizeof(id));
+    char label[MaxLabel + 1];
+    memset(label, 0, sizeof(label));
+    strcpy(label, Markers[k].Label);
+    CueBytes += stream.write((uint8_t *)label, nlabel);
+  }
+  return CueBytes;
+}
+
+
+int64_t WaveHeader::samples() const {
+  size_t nbytes = (Format.Format.bitsPerSample - 1)/8 + 1;
+  return Data.Bytes/nbytes;
+}
+
+
+bool WaveHeader::setInfo(const char *id, const char *text) {
+  if (memcmp(id, Bits.Header.Id, 4) == 0)
+    Bits.set(text);
+  else if (memcmp(id, DataBits.Header.Id, 4) == 0)
+    DataBits.set(text);
+  else if (memcmp(id, Channels.Header.Id, 4) == 0)
+    Channels.set(text);
+  else if (memcmp(id, Averaging.Header.Id, 4) == 0)
+    Averaging.set(text);
+  else if (memcmp(id, Conversion.Header.Id, 4) == 0)
+    Conversion.set(text);
+  else if (memcmp(id, Sampling.Header.Id, 4) == 0)
+    Sampling.set(text);
+  else if (memcmp(id, Reference.Header.Id, 4) == 0)
+    Reference.set(text);
+  else if (memcmp(id, Gain.Header.Id, 4) == 0)
+    Gain.set(text);
+  else if (memcmp(id, Board.Header.Id, 4) == 0)
+    Board.set(text);
+  else if (memcmp(id, MAC.Header.Id, 4) == 0)
+    MAC.set(text);
+  else if (memcmp(id, CPUSpeed.Header.Id, 4) == 0)
+    CPUSpeed.set(text);
+  else if (memcmp(id, DateTime.Header.Id, 4) == 0)
+    DateTime.set(text);
+  else if (memcmp(id, Software.Header.Id, 4) == 0)
+    Software.set(text);
+  else
+    return false;
+  return true;
+}
+
+
+bool WaveHeader::parse(const char *buffer, size_t nbuffer) {
+  NBuffer = 0;
+  NChunks = 0;
+  UseRF64 = false;
+  if (nbuffer > MaxBuffer)
+    nbuffer = MaxBuffer;
+  memset(Buffer, 0, sizeof(Buffer));
+  memcpy(Buffer, buffer, nbuffer);
+  if (nbuffer < 12 ||
+      (memcmp(Buffer, "RIFF", 4) != 0 && memcmp(Buffer, "RF64", 4) != 0) ||
+      memcmp(&Buffer[8], "WAVE", 4) != 0)
+    return false;
+  memcpy(&Riff.Header, Buffer, sizeof(ChunkHead));
+  Riff.Offset = 0;
+  // clear infos:
+  DataBits.clear();
+  Channels.clear();
+  Averaging.clear();
+  Conversion.clear();
+  Sampling.clear();
+  Reference.clear();
+  Gain.clear();
+  Board.clear();
+  MAC.clear();
+  CPUSpeed.clear();
+  DateTime.clear();
+  Software.clear();
+  DS64.clear();
+  bool ds64 = false;
+  size_t idx = 12;
+  while (idx + sizeof(ChunkHead) <= nbuffer) {
+    ChunkHead head;
+    memcpy(&head, &Buffer[idx], sizeof(ChunkHead));
+    const char *payload = &Buffer[idx + sizeof(ChunkHead)];
+    size_t npayload = nbuffer - idx - sizeof(ChunkHead);
+    if (npayload > head.Size)
+      npayload = head.Size;
+    if (memcmp(head.Id, "data", 4) == 0) {
+      memcpy(&Data.Header, &head, sizeof(ChunkHead));
+      Data.Offset = idx;
+      if (!ds64)
+	Data.Bytes = head.Size;
+      NBuffer = idx + sizeof(ChunkHead);
+      DataResolution = Format.Format.bitsPerSample;
+      if (DataBits.Use)
+	DataResolution = atoi(DataBits.text());
+      return true;
+    }
+    else if (memcmp(head.Id, "ds64", 4) == 0 ||
+	     (memcmp(head.Id, "JUNK", 4) == 0 && idx == 12 &&
+	      head.Size == sizeof(DS64.DS64))) {
+      // ds64 chunk or its placeholder:
+      UseRF64 = true;
+      DS64.Offset = idx;
+      if (memcmp(head.Id, "ds64", 4) == 0 && npayload >= sizeof(DS64.DS64)) {
+	ds64 = true;
+	memcpy(&DS64.DS64, payload, sizeof(DS64.DS64));
+	Data.Bytes = (uint64_t(DS64.DS64.dataSizeHigh) << 32) + DS64.DS64.dataSizeLow;
+      }
+    }
+    else if (memcmp(head.Id, "fmt ", 4) == 0) {
+      size_t n = sizeof(Format.Format);
+      if (n > npayload)
+	n = npayload;
+      memset(&Format.Format, 0, sizeof(Format.Format));
+      memcpy(&Format.Format, payload, n);
+      Format.Modified = true;
+    }
+    else if (memcmp(head.Id, "LIST", 4) == 0 && npayload >= 4 &&
+	     memcmp(payload, "INFO", 4) == 0) {
+      size_t k = 4;
+      while (k + sizeof(ChunkHead) <= npayload) {
+	ChunkHead info;
+	memcpy(&info, &payload[k], sizeof(ChunkHead));
+	k += sizeof(ChunkHead);
+	size_t n = info.Size;
+	if (k + n > npayload)
+	  n = npayload - k;
+	char text[MaxBuffer];
+	memcpy(text, &payload[k], n);
+	text[n] = '\0';
+	setInfo(info.Id, text);
+	k += info.Size + (info.Size & 1);
+      }
+    }
+    idx += sizeof(ChunkHead) + head.Size + (head.Size & 1);
+  }
+  return false;
+}
+
+
+bool WaveHeader::setFileSize(uint64_t filesize) {
+  if (NBuffer == 0 || filesize < NBuffer)
+    return false;
+  uint64_t riffsize = Riff.Header.Size;
+  if (UseRF64 && memcmp(Riff.Header.Id, "RF64", 4) == 0)
+    riffsize = (uint64_t(DS64.DS64.riffSizeHigh) << 32) + DS64.DS64.riffSizeLow;
+  if (riffsize + 8 == filesize)
+    return false;
+  uint64_t bytes = filesize - NBuffer;
+  if (Format.Format.blockAlign > 0)
+    bytes -= bytes % Format.Format.blockAlign;
+  if (!UseRF64 && bytes + NBuffer - 8 > 0xFFFFFFFF)
+    bytes = 0xFFFFFFFF - (NBuffer - 8);
+  ChunkHead riff = Riff.Header;
+  ChunkHead data = Data.Header;
+  uint64_t datasize = Data.Bytes;
+  Data.Bytes = bytes;
+  if (bytes > 0xFFFFFFFF)
+    Data.Header.Size = 0xFFFFFFFF;
+  else
+    Data.Header.Size = bytes;
+  setSizes(NBuffer - 8 + bytes);
+  copy(Riff);
+  if (UseRF64)
+    copy(DS64);
+  copy(Data);
+  return (memcmp(&riff, &Riff.Header, sizeof(ChunkHead)) != 0 ||
+	  memcmp(&data, &Data.Header, sizeof(ChunkHead)) != 0 ||
+	  datasize != Data.Bytes);
+}
+
+
+void WaveHeader::setSizes(uint64_t riffsize) {
+  if (UseRF64 && riffsize > 0xFFFFFFFF) {
+    // RF64 with sizes in ds64 chunk:
+    memcpy(Riff.Header.Id, "RF64", 4);
+    Riff.Header.Size = 0xFFFFFFFF;
+    Data.Header.Size = 0xFFFFFFFF;
+    uint64_t frames = 0;
+    if (Format.Format.blockAlign > 0)
+      frames = Data.Bytes/Format.Format.blockAlign;
+    DS64.set(riffsize, Data.Bytes, frames);
+  }
+  else {
+    memcpy(Riff.Header.Id, "RIFF", 4);
+    Riff.Header.Size = riffsize;
+    DS64.clear();
+  }
+}
+
+
+void WaveHeader::copy(Chunk &chunk) {
+  memcpy(&Buffer[chunk.Offset], chunk.Buffer, chunk.NBuffer);
+  chunk.Modified = false;
+}
+
+
 void WaveHeader::assemble() {
   // riff chunks:
-  const int maxchunks = 32;
   int nchunks = 0;
-  Chunk *chunks[maxchunks];
+  Chunk *chunks[MaxChunks];
   chunks[nchunks++] = &Riff;
+  if (UseRF64)
+    chunks[nchunks++] = &DS64;
   chunks[nchunks++] = &Format;
   chunks[nchunks++] = &Info;
+  int info0 = nchunks;
   chunks[nchunks++] = &Bits;
   if (DataBits.Use)
     chunks[nchunks++] = &DataBits;
@@ -238,36 +569,61 @@ void WaveHeader::assemble() {
   if (Software.Use)
     chunks[nchunks++] = &Software;
   chunks[nchunks++] = &Data;
-  if (nchunks > maxchunks)
-    Serial.println("ERROR: WaveHeader::assemble(): maxchunks too small!\n");
-  // update file size:
-  Riff.Header.Size = 4;
-  for (int k=1; k<nchunks; k++)
-    Riff.Header.Size += chunks[k]->NBuffer;
-  NBuffer = 8 + Riff.Header.Size;
-  Riff.Header.Size += Data.Header.Size;
-  // update info size:
-  Info.Header.Size = 4;
-  for (int k=3; k<nchunks-1; k++)
-    Info.addSize(chunks[k]->NBuffer);
-  // expand to next multiple of 4
-  // (without this we get some unwanted zeros into the file... why?)
-  uint32_t infosize = ((Info.Header.Size+3) >> 2) << 2;
-  infosize -= Info.Header.Size;
-  Info.Header.Size += infosize;
-  Riff.Header.Size += infosize;
-  NBuffer += infosize;
+  // check for changes of the layout:
+  bool layout = (NBuffer == 0 || nchunks != NChunks);
+  for (int k=0; k<nchunks && !layout; k++) {
+    if (chunks[k] != Chunks[k] || chunks[k]->NBuffer != chunks[k]->LayoutSize)
+      layout = true;
+  }
+  // header size:
+  uint32_t headersize = NBuffer - 8;
+  if (layout) {
+    headersize = 4;
+    for (int k=1; k<nchunks; k++)
+      headersize += chunks[k]->NBuffer;
+    NBuffer = 8 + headersize;
+    // update info size:
+    Info.Header.Size = 4;
+    for (int k=info0; k<nchunks-1; k++)
+      Info.addSize(chunks[k]->NBuffer);
+    // expand to next multiple of 4
+    // (without this we get some unwanted zeros into the file... why?)
+    uint32_t infosize = ((Info.Header.Size+3) >> 2) << 2;
+    infosize -= Info.Header.Size;
+    Info.Header.Size += infosize;
+    headersize += infosize;
+    NBuffer += infosize;
+    // offsets of chunks:
+    uint32_t idx = 0;
+    for (int k=0; k<nchunks; k++) {
+      if (chunks[k] == &Data)
+	idx += infosize;
+      chunks[k]->Offset = idx;
+      chunks[k]->LayoutSize = chunks[k]->NBuffer;
+      chunks[k]->Modified = true;
+      idx += chunks[k]->NBuffer;
+      Chunks[k] = chunks[k];
+    }
+    NChunks = nchunks;
+  }
+  setSizes(headersize + Data.Bytes + CueBytes);
   // assemble header buffer:
   if (NBuffer > MaxBuffer) {
     Serial.printf("ERROR: WaveHeader::assemble(): Header with %d bytes too large! You need to increase MaxBuffer in WaveHeader.\n\n", NBuffer);
     NBuffer = 0;
+    NChunks = 0;
+    return;
   }
-  memset(Buffer, 0, sizeof(Buffer));
-  uint32_t idx = 0;
-  for (int k=0; k<nchunks-1; k++) {
-    memcpy(&Buffer[idx], chunks[k]->Buffer, chunks[k]->NBuffer);
-    idx += chunks[k]->NBuffer;
+  if (layout)
+    memset(Buffer, 0, sizeof(Buffer));
+  // size fields:
+  copy(Riff);
+  if (UseRF64)
+    copy(DS64);
+  copy(Data);
+  // modified chunks:
+  for (int k=0; k<nchunks; k++) {
+    if (chunks[k]->Modified)
+      copy(*chunks[k]);
   }
-  idx += infosize;
-  memcpy(&Buffer[idx], Data.Buffer, Data.NBuffer);
 }
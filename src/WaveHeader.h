@@ -63,7 +63,23 @@ public:
 
   // Set size of data chunk.
   // Call this *after* setFormat().
-  void setData(int32_t samples=0);
+  void setData(int64_t samples=0);
+
+  // True if the header is prepared for RF64 files larger than 4GB.
+  bool rf64() const { return UseRF64; };
+
+  // Prepare header for files larger than 4GB (RF64).
+  // If enabled, the header contains a 28 byte "JUNK" chunk reserving
+  // space for a "ds64" chunk. The JUNK chunk is replaced by the ds64 chunk
+  // and the header is turned into a RF64 header as soon as the data
+  // exceed the 4GB limit of RIFF files.
+  // This way the header keeps its size and can be rewritten in place.
+  // Files smaller than 4GB remain valid RIFF/WAVE files.
+  // Large files need a SD card formatted with exFAT.
+  void setRF64(bool rf64=true);
+
+  // True if the size of the data set with setData() requires RF64.
+  bool isRF64() const;
 
   // Return string describing start time of recording.
   const char *dateTime() const { return DateTime.text(); };
@@ -89,8 +105,73 @@ public:
   // Set CPU speed to current CPU speed.
   void setCPUSpeed();
 
+  // Maximum number of markers.
+  static const size_t MaxMarkers = 32;
+
+  // Maximum number of characters of a marker label.
+  static const size_t MaxLabel = 16;
+
+  // Add marker at frame (sample index of each channel relative to
+  // the beginning of the data) with optional label.
+  // Markers are written as cue chunk with labels in an adtl list
+  // by writeCues().
+  // Return false if there is no space left for the marker.
+  bool addMarker(uint32_t frame, const char *label=0);
+
+  // Number of markers.
+  size_t markers() const { return NMarkers; };
+
+  // Frame of index-th marker.
+  uint32_t markerFrame(size_t index) const { return Markers[index].Frame; };
+
+  // Label of index-th marker.
+  const char *markerLabel(size_t index) const { return Markers[index].Label; };
+
+  // Remove all markers.
+  void clearMarkers();
+
+  // Write cue chunk and adtl list chunk with labels of all markers
+  // within the data set by setData() to stream.
+  // Call this right after the data have been written and before
+  // the final assemble(), which then includes the cue chunks
+  // into the size of the RIFF chunk.
+  // Return number of written bytes.
+  size_t writeCues(Print &stream);
+
+  // Number of channels.
+  uint8_t nchannels() const { return Format.Format.numChannels; };
+
+  // Sampling rate in Hertz.
+  uint32_t rate() const { return Format.Format.sampleRate; };
+
+  // Number of bits per sample used for storing the data.
+  uint16_t bitsPerSample() const { return Format.Format.bitsPerSample; };
+
+  // Number of samples (of all channels) in the data chunk.
+  int64_t samples() const;
+
+  // Parse the wave header from the first nbuffer bytes of a wave file
+  // in buffer. The header needs to fit into MaxBuffer bytes.
+  // Format, INFO chunks, and data size are retrieved and the header
+  // is copied into Buffer. NBuffer is then the size of the header
+  // up to the data, i.e. the offset of the data in the file.
+  // Return true if a RIFF or RF64 header with data chunk was found.
+  bool parse(const char *buffer, size_t nbuffer);
+
+  // Set the sizes of the RIFF and data chunk in the Buffer of a header
+  // successfully read by parse() according to the file size in bytes.
+  // Use this to repair wave files that have not been closed properly.
+  // Nothing is changed if the size of the RIFF chunk already matches
+  // the file size.
+  // Return true if the sizes in the header changed.
+  bool setFileSize(uint64_t filesize);
+
   // Assemble wave header from previously set infos.
   // The header can then be retrieved from Buffer.
+  // The layout of the header is only recomputed if the set of chunks
+  // or the size of a chunk changed. Otherwise only modified chunks
+  // and the size fields are copied into Buffer in place.
+  // This makes updating the size of the data via setData() cheap.
   void assemble();
 
 
@@ -109,6 +190,9 @@ protected:
     char *Buffer;
     uint32_t NBuffer;
     bool Use;
+    bool Modified;       // content changed since last assemble().
+    uint32_t Offset;     // position of chunk in assembled header.
+    uint32_t LayoutSize; // size of chunk in assembled header.
     ChunkHead Header;
   };
 
@@ -148,16 +232,55 @@ protected:
     char Text[N];
   };
 
+  class DS64Chunk : public Chunk {
+
+    // 64-bit sizes are split into two 32-bit words,
+    // because the chunk must not contain padding:
+    typedef struct {
+      uint32_t riffSizeLow;      // size of RF64 chunk
+      uint32_t riffSizeHigh;
+      uint32_t dataSizeLow;      // size of data chunk
+      uint32_t dataSizeHigh;
+      uint32_t sampleCountLow;   // number of frames
+      uint32_t sampleCountHigh;
+      uint32_t tableLength;      // number of entries in size table
+    } DS64_t;
+
+  public:
+    DS64Chunk();
+    void set(uint64_t riffsize, uint64_t datasize, uint64_t samplecount);
+    void clear();
+    DS64_t DS64;
+  };
+
   class DataChunk : public Chunk {
   public:
     DataChunk();
-    DataChunk(uint16_t resolution, int32_t samples);
-    void set(uint16_t resolution, int32_t samples);
+    DataChunk(uint16_t resolution, int64_t samples);
+    void set(uint16_t resolution, int64_t samples);
+    uint64_t Bytes;    // size of data in bytes
   };
 
+  // Copy chunk into Buffer at its offset.
+  void copy(Chunk &chunk);
+
+  // Set text of the INFO chunk with identifier id.
+  // Return false if id is not known.
+  bool setInfo(const char *id, const char *text);
+
+  // Set sizes of RIFF, ds64, and data chunk for riffsize.
+  void setSizes(uint64_t riffsize);
+
   uint16_t DataResolution;
+  bool UseRF64;
+
+  // Chunks of the currently assembled header:
+  static const int MaxChunks = 32;
+  int NChunks;
+  Chunk *Chunks[MaxChunks];
 
   ListChunk Riff;
+  DS64Chunk DS64;
   FormatChunk Format;
   ListChunk Info;
   InfoChunk<4> Bits;
@@ -175,6 +298,15 @@ protected:
   InfoChunk<64> Software;
   DataChunk Data;
 
+  typedef struct {
+    uint32_t Frame;
+    char Label[MaxLabel];
+  } Marker;
+
+  size_t NMarkers;
+  Marker Markers[MaxMarkers];
+  uint32_t CueBytes;   // number of bytes written by writeCues().
+
 };
 
 
@@ -0,0 +1,157 @@
+// Host benchmark of the Resampler used by AudioPlayBuffer.
+// Resamples pure tones to the audio rate of the Teensy Audio library
+// in blocks of 128 samples, as AudioPlayBuffer::update() does, and
+// reports the residual error to the ideal tone and the CPU time per
+// block. For comparison, the same is done with the nearest-sample
+// stepping on a floating point time that AudioPlayBuffer used before.
+
+#include <Arduino.h>
+#include <Resampler.h>
+#include <chrono>
+#include <vector>
+#include "check.h"
+
+
+static const float AudioRate = 44117.64706;   // AUDIO_SAMPLE_RATE_EXACT
+static const size_t BlockSamples = 128;       // AUDIO_BLOCK_SAMPLES
+static const float Amplitude = 16000.0;
+
+
+// Nearest-sample resampling on a floating point time.
+class TimeStepper {
+
+ public:
+
+  TimeStepper(float rate) : Rate(rate), Time(0.0) {};
+
+  // Fill block with BlockSamples samples from data.
+  // Return number of consumed input samples.
+  size_t block(const int16_t *data, size_t navail, int16_t *block) {
+    double interval = 1.0/AudioRate;
+    size_t index = 0;
+    for (size_t i=0; i<BlockSamples; i++) {
+      block[i] = data[index];
+      Time += interval;
+      while (navail > 0 && Time > (index + 1)/Rate) {
+	navail--;
+	index++;
+      }
+    }
+    Time -= index/Rate;
+    return index;
+  };
+
+ protected:
+
+  double Rate;
+  double Time;
+};
+
+
+// Residual error in decibel relative to the tone power of resampled
+// data y after fitting a tone of frequency freq with arbitrary phase.
+// Tones above the Nyquist frequency of the output should be removed
+// completely.
+static double residual(const std::vector<int16_t> &y, double freq) {
+  size_t offs = 2048;   // skip filter transient
+  size_t n = y.size() - 2*offs;
+  bool passband = freq < 0.5*AudioRate;
+  double ss = 0.0;
+  double cc = 0.0;
+  double sc = 0.0;
+  double ys = 0.0;
+  double yc = 0.0;
+  for (size_t i=offs; passband && i<offs+n; i++) {
+    double s = sin(2.0*PI*freq*i/AudioRate);
+    double c = cos(2.0*PI*freq*i/AudioRate);
+    ss += s*s;
+    cc += c*c;
+    sc += s*c;
+    ys += y[i]*s;
+    yc += y[i]*c;
+  }
+  double det = ss*cc - sc*sc;
+  double a = 0.0;
+  double b = 0.0;
+  if (passband && det > 0.0) {
+    a = (ys*cc - yc*sc)/det;
+    b = (yc*ss - ys*sc)/det;
+  }
+  double err = 0.0;
+  for (size_t i=offs; i<offs+n; i++) {
+    double e = y[i];
+    if (passband)
+      e -= a*sin(2.0*PI*freq*i/AudioRate) + b*cos(2.0*PI*freq*i/AudioRate);
+    err += e*e;
+  }
+  err /= n;
+  if (err < 1e-12)
+    err = 1e-12;
+  return 10.0*log10(err/(0.5*Amplitude*Amplitude));
+}
+
+
+// Resample two seconds of a tone of frequency freq sampled at rate.
+// Return residual error in decibel and time per block in microseconds.
+static double resample(float rate, float freq, bool resampler, double *us) {
+  size_t n = 2*rate;
+  std::vector<int16_t> x(n);
+  for (size_t i=0; i<n; i++)
+    x[i] = Amplitude*sin(2.0*PI*freq*i/rate);
+  std::vector<int16_t> y;
+  y.reserve(3*AudioRate);
+  Resampler rs;
+  rs.setup(rate, AudioRate);
+  TimeStepper ts(rate);
+  int16_t block[BlockSamples];
+  size_t j = 0;
+  size_t nblocks = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (j + rs.frames(BlockSamples) < n) {
+    if (resampler) {
+      for (size_t i=0; i<BlockSamples; i++) {
+	int16_t left;
+	int16_t right;
+	rs.output(left, right);
+	block[i] = left;
+	size_t m = rs.advance();
+	for (size_t k=0; k<m; k++, j++)
+	  rs.push(x[j], x[j]);
+      }
+    }
+    else
+      j += ts.block(&x[j], n - j, block);
+    y.insert(y.end(), block, block + BlockSamples);
+    nblocks++;
+  }
+  auto stop = std::chrono::steady_clock::now();
+  *us = std::chrono::duration<double, std::micro>(stop - start).count()/nblocks;
+  return residual(y, freq);
+}
+
+
+int main() {
+  const float rates[] = {22050, 48000, 96000, 192000, 250000};
+  const float freqs[] = {1000, 30000, 60000};
+  printf("Resampling tones to %.0fHz in blocks of %zu samples:\n",
+	 AudioRate, BlockSamples);
+  printf("  rate     tone      Resampler            time stepping\n");
+  printf("  Hz       Hz        error    time        error    time\n");
+  for (float rate : rates) {
+    for (float freq : freqs) {
+      if (freq > 0.5*rate)
+	continue;
+      double usnew;
+      double usold;
+      double errnew = resample(rate, freq, true, &usnew);
+      double errold = resample(rate, freq, false, &usold);
+      printf("  %6.0f  %6.0f  %6.1fdB  %5.2fus/block  %6.1fdB  %5.2fus/block\n",
+	     rate, freq, errnew, usnew, errold, usold);
+      // tones in the pass band are reproduced and tones above the
+      // Nyquist frequency of the audio rate are removed:
+      if (freq < 0.42*AudioRate || freq > 0.58*AudioRate)
+	CHECK(errnew < -50.0);
+    }
+  }
+  return report("bench_resampler");
+}
@@ -0,0 +1,24 @@
+// Minimal checks for the host tests.
+
+#ifndef check_h
+#define check_h
+
+
+#include <stdio.h>
+
+
+static int CheckFailures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { CheckFailures++; fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); } } while (0)
+
+// Report result and return exit code.
+static inline int report(const char *name) {
+  if (CheckFailures > 0)
+    fprintf(stderr, "%s: %d checks FAILED\n", name, CheckFailures);
+  else
+    printf("%s: all checks passed\n", name);
+  return CheckFailures > 0 ? 1 : 0;
+}
+
+
+#endif
@@ -0,0 +1,117 @@
+#include <Arduino.h>
+#include <chrono>
+
+
+uint64_t HostDelay = 0;
+
+usb_serial_class Serial;
+
+
+static const auto HostStart = std::chrono::steady_clock::now();
+
+
+uint32_t millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - HostStart).count();
+}
+
+
+uint32_t micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - HostStart).count();
+}
+
+
+void delay(uint32_t ms) {
+  HostDelay += ms;
+}
+
+
+void delayMicroseconds(uint32_t us) {
+}
+
+
+void yield() {
+}
+
+
+void String::replace(const char *a, const char *b) {
+  size_t na = strlen(a);
+  size_t nb = strlen(b);
+  if (na == 0)
+    return;
+  size_t i = 0;
+  while ((i = S.find(a, i)) != std::string::npos) {
+    S.replace(i, na, b);
+    i += nb;
+  }
+}
+
+
+void String::trim() {
+  size_t i = S.find_first_not_of(" \t\r\n");
+  if (i == std::string::npos) {
+    S.clear();
+    return;
+  }
+  S = S.substr(i, S.find_last_not_of(" \t\r\n") - i + 1);
+}
+
+
+size_t Print::write(const uint8_t *buffer, size_t n) {
+  size_t m = 0;
+  for (size_t k=0; k<n; k++)
+    m += write(buffer[k]);
+  return m;
+}
+
+
+size_t Print::print(long val, int base) {
+  char s[32];
+  snprintf(s, sizeof(s), base == HEX ? "%lx" : "%ld", val);
+  return write(s);
+}
+
+
+size_t Print::print(unsigned long val, int base) {
+  char s[32];
+  snprintf(s, sizeof(s), base == HEX ? "%lx" : "%lu", val);
+  return write(s);
+}
+
+
+size_t Print::print(double val, int digits) {
+  char s[64];
+  snprintf(s, sizeof(s), "%.*f", digits, val);
+  return write(s);
+}
+
+
+int Print::printf(const char *format, ...) {
+  char s[1024];
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(s, sizeof(s), format, args);
+  va_end(args);
+  write(s);
+  return n;
+}
+
+
+size_t Stream::readBytes(char *buffer, size_t n) {
+  size_t k = 0;
+  while (k < n) {
+    int c = read();
+    if (c < 0)
+      break;
+    buffer[k++] = c;
+  }
+  return k;
+}
+
+
+String Stream::readStringUntil(char terminator) {
+  String s;
+  int c;
+  while ((c = read()) >= 0 && c != terminator)
+    s += (char)c;
+  return s;
+}
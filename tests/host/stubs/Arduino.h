@@ -0,0 +1,250 @@
+/*
+  Arduino - Minimal host replacement of the Teensyduino core
+  for running parts of the TeeRec library on a PC.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+#include <ctype.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <string>
+
+
+#define TEENSYDUINO 159
+#ifndef __IMXRT1062__
+#define __IMXRT1062__
+#endif
+#define ARDUINO_TEENSY41
+#define F_CPU 600000000
+#define F_CPU_ACTUAL 600000000
+#define WIRE_INTERFACES_COUNT 3
+
+#define EXTMEM
+#define DMAMEM
+#define FASTRUN
+#define FLASHMEM
+#define PROGMEM
+
+#define PI 3.141592653589793
+#define TWO_PI 6.283185307179586
+#define LED_BUILTIN 13
+#define BUILTIN_SDCARD 254
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define HIGH 1
+#define LOW 0
+#define DEC 10
+#define HEX 16
+
+typedef uint8_t byte;
+typedef unsigned int uint;
+
+// Like in the Teensyduino core, min() and max() accept mixed types.
+template<class A, class B> auto min(const A &a, const B &b) -> decltype(a < b ? a : b)
+  { return b < a ? b : a; }
+template<class A, class B> auto max(const A &a, const B &b) -> decltype(a < b ? a : b)
+  { return a < b ? b : a; }
+
+template<class T, class L, class H> T constrain(T x, L l, H h)
+  { return x < l ? l : (x > h ? h : x); }
+
+// Time since start of the program, measured on the host.
+uint32_t millis();
+uint32_t micros();
+
+// Does not sleep, but adds ms to HostDelay.
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// Milliseconds passed to delay() so far.
+extern uint64_t HostDelay;
+
+static inline void interrupts() {}
+static inline void noInterrupts() {}
+static inline void __disable_irq() {}
+static inline void __enable_irq() {}
+
+static inline void pinMode(uint8_t, uint8_t) {}
+static inline void digitalWrite(uint8_t, uint8_t) {}
+static inline int digitalRead(uint8_t) { return LOW; }
+static inline void analogWrite(uint8_t, int) {}
+
+enum { A0=14, A1=15, A2=16, A3=17, A4=18, A5=19, A6=20, A7=21, A8=22,
+       A9=23, A10=24, A11=25, A12=26, A13=27, A14=28, A15=29, A16=30,
+       A17=31, A18=32, A19=33, A20=34, A21=35, A22=36, A23=37, A24=38,
+       A25=39, A26=40, A27=41 };
+
+
+class String {
+
+ public:
+
+  String(const char *s="") : S(s != 0 ? s : "") {};
+  String(const std::string &s) : S(s) {};
+  String(char c) : S(1, c) {};
+  String(int val) : S(std::to_string(val)) {};
+  String(unsigned int val) : S(std::to_string(val)) {};
+  String(long val) : S(std::to_string(val)) {};
+  String(unsigned long val) : S(std::to_string(val)) {};
+
+  String &operator=(const char *s) { S = s != 0 ? s : ""; return *this; };
+  bool operator==(const String &s) const { return S == s.S; };
+  bool operator!=(const String &s) const { return S != s.S; };
+  bool operator==(const char *s) const { return S == s; };
+  bool operator!=(const char *s) const { return S != s; };
+  String operator+(const String &s) const { return String(S + s.S); };
+  String operator+(const char *s) const { return String(S + s); };
+  friend String operator+(const char *a, const String &b)
+    { return String(std::string(a) + b.S); };
+  String &operator+=(const String &s) { S += s.S; return *this; };
+  String &operator+=(const char *s) { S += s; return *this; };
+  String &operator+=(char c) { S += c; return *this; };
+  char operator[](unsigned int i) const { return i < S.size() ? S[i] : '\0'; };
+  char &operator[](unsigned int i) { return S[i]; };
+
+  unsigned int length() const { return S.size(); };
+  const char *c_str() const { return S.c_str(); };
+  int indexOf(const char *s, unsigned int from=0) const
+    { size_t i = S.find(s, from); return i == std::string::npos ? -1 : i; };
+  int indexOf(const String &s, unsigned int from=0) const
+    { return indexOf(s.c_str(), from); };
+  int indexOf(char c, unsigned int from=0) const
+    { size_t i = S.find(c, from); return i == std::string::npos ? -1 : i; };
+  int lastIndexOf(char c) const
+    { size_t i = S.rfind(c); return i == std::string::npos ? -1 : i; };
+  String substring(unsigned int from) const
+    { return from < S.size() ? String(S.substr(from)) : String(); };
+  String substring(unsigned int from, unsigned int to) const
+    { return from < to && from < S.size() ? String(S.substr(from, to - from)) : String(); };
+  bool startsWith(const char *s) const { return S.compare(0, strlen(s), s) == 0; };
+  bool endsWith(const char *s) const
+    { size_t n = strlen(s); return S.size() >= n && S.compare(S.size() - n, n, s) == 0; };
+  void replace(const char *a, const char *b);
+  void replace(const String &a, const String &b) { replace(a.c_str(), b.c_str()); };
+  void toLowerCase() { for (auto &c : S) c = tolower(c); };
+  void toUpperCase() { for (auto &c : S) c = toupper(c); };
+  void trim();
+  long toInt() const { return atol(S.c_str()); };
+  float toFloat() const { return atof(S.c_str()); };
+
+ private:
+
+  std::string S;
+};
+
+
+class Print {
+
+ public:
+
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t n);
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); };
+  size_t write(const char *s, size_t n) { return write((const uint8_t *)s, n); };
+  virtual int availableForWrite() { return 0; };
+  virtual void flush() {};
+
+  size_t print(const char *s) { return write(s); };
+  size_t print(const String &s) { return write(s.c_str()); };
+  size_t print(char c) { return write((uint8_t)c); };
+  size_t print(int val, int base=DEC) { return print((long)val, base); };
+  size_t print(unsigned int val, int base=DEC) { return print((unsigned long)val, base); };
+  size_t print(long val, int base=DEC);
+  size_t print(unsigned long val, int base=DEC);
+  size_t print(double val, int digits=2);
+
+  size_t println() { return write("\n"); };
+  template<class T> size_t println(T val) { return print(val) + println(); };
+  template<class T> size_t println(T val, int f) { return print(val, f) + println(); };
+
+  int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+
+class Stream : public Print {
+
+ public:
+
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  size_t readBytes(char *buffer, size_t n);
+  String readStringUntil(char terminator);
+  void setTimeout(unsigned long) {};
+};
+
+
+// Writes to stdout, reads nothing.
+class usb_serial_class : public Stream {
+
+ public:
+
+  void begin(long) {};
+  virtual int available() { return 0; };
+  virtual int read() { return -1; };
+  virtual int peek() { return -1; };
+  virtual size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; };
+  virtual size_t write(const uint8_t *buffer, size_t n)
+    { return fwrite(buffer, 1, n, stdout); };
+  using Print::write;
+  virtual int availableForWrite() { return 1024; };
+  virtual void flush() { fflush(stdout); };
+  operator bool() { return true; };
+};
+
+extern usb_serial_class Serial;
+
+
+class elapsedMillis {
+
+ public:
+
+  elapsedMillis(uint32_t val=0) { Start = millis() - val; };
+  operator uint32_t() const { return millis() - Start; };
+  elapsedMillis &operator=(uint32_t val) { Start = millis() - val; return *this; };
+  elapsedMillis &operator-=(uint32_t val) { Start += val; return *this; };
+  elapsedMillis &operator+=(uint32_t val) { Start -= val; return *this; };
+
+ private:
+
+  uint32_t Start;
+};
+
+
+class elapsedMicros {
+
+ public:
+
+  elapsedMicros(uint32_t val=0) { Start = micros() - val; };
+  operator uint32_t() const { return micros() - Start; };
+  elapsedMicros &operator=(uint32_t val) { Start = micros() - val; return *this; };
+  elapsedMicros &operator-=(uint32_t val) { Start += val; return *this; };
+  elapsedMicros &operator+=(uint32_t val) { Start -= val; return *this; };
+
+ private:
+
+  uint32_t Start;
+};
+
+
+// Like newlib, strstr() and friends return non-const pointers.
+#define strstr(s, n) ((char *)::strstr(s, n))
+#define strchr(s, c) ((char *)::strchr(s, c))
+#define strrchr(s, c) ((char *)::strrchr(s, c))
+
+
+#endif
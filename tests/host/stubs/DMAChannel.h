@@ -0,0 +1,24 @@
+/*
+  DMAChannel - Host replacement of the Teensyduino DMA channels.
+*/
+
+#ifndef DMAChannel_h
+#define DMAChannel_h
+
+
+#include <Arduino.h>
+
+
+class DMASetting {
+};
+
+
+class DMAChannel : public DMASetting {
+
+ public:
+
+  void begin(bool force=false) {};
+};
+
+
+#endif
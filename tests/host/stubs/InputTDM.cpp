@@ -0,0 +1,13 @@
+// The TDM input needs the I2S hardware of the Teensy.
+// Only the functions used by the codec drivers are provided.
+
+#include <InputTDM.h>
+
+
+void InputTDM::downSample(uint8_t downsample) {
+}
+
+
+void InputTDM::addNChannels(TDM_BUS bus, TDM_DATA data, uint8_t nchannels,
+			    const char **chan_strs) {
+}
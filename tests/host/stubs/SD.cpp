@@ -0,0 +1,314 @@
+#include <SD.h>
+#include <TimeLib.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+
+
+const char *HostSDRoot = "sdcard";
+SDClass SD;
+
+
+FsFile::State::~State() {
+  if (File != 0)
+    fclose(File);
+}
+
+
+bool FsFile::open(const std::string &path, int oflag) {
+  close();
+  struct stat st;
+  bool exists = (stat(path.c_str(), &st) == 0);
+  auto state = std::make_shared<State>();
+  state->Path = path;
+  if (exists && S_ISDIR(st.st_mode)) {
+    DIR *dir = opendir(path.c_str());
+    if (dir == 0)
+      return false;
+    while (struct dirent *entry = readdir(dir)) {
+      if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+	state->Entries.push_back(entry->d_name);
+    }
+    closedir(dir);
+    std::sort(state->Entries.begin(), state->Entries.end());
+    state->Dir = true;
+    F = state;
+    return true;
+  }
+  if (!exists && (oflag & O_CREAT) == 0)
+    return false;
+  if (!exists || (oflag & O_TRUNC) != 0) {
+    FILE *f = fopen(path.c_str(), "wb");
+    if (f == 0)
+      return false;
+    fclose(f);
+  }
+  state->File = fopen(path.c_str(), (oflag & O_ACCMODE) == O_RDONLY ? "rb" : "r+b");
+  if (state->File == 0)
+    return false;
+  if ((oflag & O_AT_END) != 0)
+    fseek(state->File, 0, SEEK_END);
+  F = state;
+  return true;
+}
+
+
+bool FsFile::openNext(FsFile *dir, int oflag) {
+  close();
+  if (!dir->isDir())
+    return false;
+  while (dir->F->Next < dir->F->Entries.size()) {
+    std::string path = dir->F->Path + "/" + dir->F->Entries[dir->F->Next++];
+    if (open(path, oflag & ~(O_CREAT | O_TRUNC)))
+      return true;
+  }
+  return false;
+}
+
+
+bool FsFile::close() {
+  F.reset();
+  return true;
+}
+
+
+size_t FsFile::getName(char *name, size_t size) const {
+  if (!F || size == 0)
+    return 0;
+  size_t i = F->Path.rfind('/');
+  std::string base = i == std::string::npos ? F->Path : F->Path.substr(i + 1);
+  strncpy(name, base.c_str(), size);
+  name[size - 1] = '\0';
+  return strlen(name);
+}
+
+
+uint64_t FsFile::fileSize() const {
+  if (!F || F->File == 0)
+    return 0;
+  fflush(F->File);
+  struct stat st;
+  if (fstat(fileno(F->File), &st) != 0)
+    return 0;
+  return st.st_size;
+}
+
+
+uint64_t FsFile::curPosition() const {
+  if (!F || F->File == 0)
+    return 0;
+  return ftello(F->File);
+}
+
+
+bool FsFile::seek(uint64_t pos) {
+  if (!F || F->File == 0)
+    return false;
+  return fseeko(F->File, pos, SEEK_SET) == 0;
+}
+
+
+bool FsFile::sync() {
+  if (!F || F->File == 0)
+    return false;
+  return fflush(F->File) == 0;
+}
+
+
+bool FsFile::truncate(uint64_t length) {
+  if (!F || F->File == 0)
+    return false;
+  fflush(F->File);
+  if (ftruncate(fileno(F->File), length) != 0)
+    return false;
+  return seek(length);
+}
+
+
+bool FsFile::preAllocate(uint64_t length) {
+  return fileSize() == 0;
+}
+
+
+bool FsFile::getCreateDateTime(uint16_t *pdate, uint16_t *ptime) const {
+  struct stat st;
+  if (!F || stat(F->Path.c_str(), &st) != 0)
+    return false;
+  time_t t = st.st_mtime;
+  *pdate = FS_DATE(year(t), month(t), day(t));
+  *ptime = FS_TIME(hour(t), minute(t), second(t));
+  return true;
+}
+
+
+int FsFile::read(void *buffer, size_t n) {
+  if (!F || F->File == 0)
+    return -1;
+  return fread(buffer, 1, n, F->File);
+}
+
+
+int FsFile::read() {
+  if (!F || F->File == 0)
+    return -1;
+  return fgetc(F->File);
+}
+
+
+int FsFile::peek() {
+  int c = read();
+  if (c != EOF)
+    ungetc(c, F->File);
+  return c;
+}
+
+
+int FsFile::available() {
+  uint64_t n = fileSize() - curPosition();
+  return n > 0x7fffffff ? 0x7fffffff : int(n);
+}
+
+
+size_t FsFile::write(const uint8_t *buffer, size_t n) {
+  if (!F || F->File == 0)
+    return 0;
+  return fwrite(buffer, 1, n, F->File);
+}
+
+
+bool FsFile::remove() {
+  if (!F || F->Dir)
+    return false;
+  std::string path = F->Path;
+  close();
+  return ::remove(path.c_str()) == 0;
+}
+
+
+bool FsFile::remove(const char *path) {
+  if (!isDir())
+    return false;
+  return ::remove((F->Path + "/" + path).c_str()) == 0;
+}
+
+
+bool FsFile::mkdir(FsFile *parent, const char *name, bool pflag) {
+  if (!parent->isDir())
+    return false;
+  std::string path = parent->F->Path + "/" + name;
+  if (::mkdir(path.c_str(), 0755) != 0)
+    return false;
+  return open(path);
+}
+
+
+bool FsFile::rmdir() {
+  if (!isDir())
+    return false;
+  std::string path = F->Path;
+  close();
+  return ::rmdir(path.c_str()) == 0;
+}
+
+
+bool SdFs::begin(uint8_t cs) {
+  struct stat st;
+  if (stat(HostSDRoot, &st) != 0 || !S_ISDIR(st.st_mode))
+    return false;
+  Root = HostSDRoot;
+  Cwd = "/";
+  return true;
+}
+
+
+bool SdFs::chdir(const char *path) {
+  std::string host = hostPath(path);
+  struct stat st;
+  if (stat(host.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+    return false;
+  Cwd = host.substr(Root.size());
+  if (Cwd.empty())
+    Cwd = "/";
+  return true;
+}
+
+
+std::string SdFs::hostPath(const char *path) const {
+  std::string p = path;
+  if (p.empty() || p[0] != '/')
+    p = Cwd + (Cwd.back() == '/' ? "" : "/") + p;
+  while (p.size() > 1 && p.back() == '/')
+    p.pop_back();
+  return p == "/" ? Root : Root + p;
+}
+
+
+FsFile SdFs::open(const char *path, int oflag) {
+  FsFile file;
+  if (!Root.empty())
+    file.open(hostPath(path), oflag);
+  return file;
+}
+
+
+bool SdFs::exists(const char *path) {
+  struct stat st;
+  return !Root.empty() && stat(hostPath(path).c_str(), &st) == 0;
+}
+
+
+bool SdFs::mkdir(const char *path, bool pflag) {
+  return !Root.empty() && ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+
+bool SdFs::remove(const char *path) {
+  return !Root.empty() && ::unlink(hostPath(path).c_str()) == 0;
+}
+
+
+bool SdFs::rename(const char *oldpath, const char *newpath) {
+  return !Root.empty() &&
+    ::rename(hostPath(oldpath).c_str(), hostPath(newpath).c_str()) == 0;
+}
+
+
+bool SdFs::rmdir(const char *path) {
+  return !Root.empty() && ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+
+time_t now() {
+  return time(0);
+}
+
+
+int year(time_t t) {
+  return localtime(&t)->tm_year + 1900;
+}
+
+
+int month(time_t t) {
+  return localtime(&t)->tm_mon + 1;
+}
+
+
+int day(time_t t) {
+  return localtime(&t)->tm_mday;
+}
+
+
+int hour(time_t t) {
+  return localtime(&t)->tm_hour;
+}
+
+
+int minute(time_t t) {
+  return localtime(&t)->tm_min;
+}
+
+
+int second(time_t t) {
+  return localtime(&t)->tm_sec;
+}
@@ -0,0 +1,218 @@
+/*
+  SD - Host replacement of the Teensyduino SD and SdFat libraries.
+  An SD card is a directory on the host file system, HostSDRoot
+  at the time begin() is called.
+*/
+
+#ifndef SD_h
+#define SD_h
+
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+#define O_READ O_RDONLY
+#define O_WRITE O_WRONLY
+#define O_AT_END 0x40000000
+
+#define FS_DATE(year, month, day) \
+  ((year) > 1980 ? ((year) - 1980) << 9 | (month) << 5 | (day) : 0)
+#define FS_TIME(hour, minute, second) \
+  ((hour) << 11 | (minute) << 5 | (second) >> 1)
+
+#define DEDICATED_SPI 1
+#define SHARED_SPI 0
+#define SD_SCK_MHZ(mhz) (1000000UL*(mhz))
+
+#define SD_CARD_TYPE_SD1 1
+#define SD_CARD_TYPE_SD2 2
+#define SD_CARD_TYPE_SDHC 3
+
+
+// Directory on the host file system used as SD card by begin().
+extern const char *HostSDRoot;
+
+
+// File or directory on the host file system.
+class FsFile : public Stream {
+
+ public:
+
+  FsFile() {};
+
+  operator bool() const { return F != 0; };
+  bool isOpen() const { return F != 0; };
+  bool isDir() const { return F != 0 && F->Dir; };
+
+  // Open path on the host file system.
+  bool open(const std::string &path, int oflag=O_RDONLY);
+  // Open next entry of directory dir.
+  bool openNext(FsFile *dir, int oflag=O_RDONLY);
+  bool close();
+
+  size_t getName(char *name, size_t size) const;
+  uint64_t fileSize() const;
+  uint64_t size() const { return fileSize(); };
+  uint64_t curPosition() const;
+  uint64_t position() const { return curPosition(); };
+  bool seek(uint64_t pos);
+  bool seekSet(uint64_t pos) { return seek(pos); };
+  void rewind() { seek(0); };
+  bool sync();
+  bool truncate(uint64_t length);
+  bool truncate() { return truncate(curPosition()); };
+  bool preAllocate(uint64_t length);
+  bool getCreateDateTime(uint16_t *pdate, uint16_t *ptime) const;
+
+  int read(void *buffer, size_t n);
+  virtual int read();
+  virtual int peek();
+  virtual int available();
+  virtual size_t write(uint8_t c) { return write(&c, 1); };
+  virtual size_t write(const uint8_t *buffer, size_t n);
+  size_t write(const void *buffer, size_t n)
+    { return write((const uint8_t *)buffer, n); };
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); };
+  using Print::write;
+  virtual void flush() { sync(); };
+
+  // Remove this file.
+  bool remove();
+  // Remove file path in this directory.
+  bool remove(const char *path);
+  // Make directory name in parent and open it.
+  bool mkdir(FsFile *parent, const char *name, bool pflag=true);
+  // Remove this empty directory.
+  bool rmdir();
+
+  static void dateTimeCallback(void (*)(uint16_t *, uint16_t *)) {};
+
+ protected:
+
+  struct State {
+    ~State();
+    std::string Path;
+    bool Dir = false;
+    FILE *File = 0;
+    std::vector<std::string> Entries;
+    size_t Next = 0;
+  };
+
+  std::shared_ptr<State> F;
+};
+
+typedef FsFile SdFile;
+typedef FsFile File;
+
+
+struct cid_t {
+  uint8_t mid = 0x03;
+  char oid[2] = {'S', 'D'};
+  char pnm[5] = {'H', 'O', 'S', 'T', '0'};
+  uint8_t prv_n = 1;
+  uint8_t prv_m = 0;
+  uint32_t psn = 0x12345678;
+  uint8_t mdt_year_high = 2;
+  uint8_t mdt_year_low = 4;
+  uint8_t mdt_month = 10;
+};
+
+struct csd_t {
+  uint32_t sectors;
+};
+
+static inline uint32_t sdCardCapacity(csd_t *csd) { return csd->sectors; }
+
+
+// Simulated 32GB SDHC card.
+class SdCard {
+
+ public:
+
+  uint8_t type() const { return SD_CARD_TYPE_SDHC; };
+  uint32_t sectorCount() const { return 62500000; };
+  bool readCID(cid_t *cid) const { *cid = cid_t(); return true; };
+  bool readCSD(csd_t *csd) const { csd->sectors = sectorCount(); return true; };
+  bool syncDevice() { return true; };
+  bool erase(uint32_t, uint32_t) { return true; };
+};
+
+
+class FatFormatter {
+
+ public:
+
+  bool format(SdCard *, uint8_t *, Print *) { return false; };
+};
+
+typedef FatFormatter ExFatFormatter;
+
+
+struct SdSpiConfig {
+  SdSpiConfig(uint8_t cs, uint8_t opt, uint32_t clock, SPIClass *spi) {};
+};
+
+
+class SdFs {
+
+ public:
+
+  bool begin(uint8_t cs);
+  bool begin(const SdSpiConfig &) { return begin(0); };
+  void end() { Root = ""; };
+  bool restart() { return begin(0); };
+  bool chvol() { return true; };
+  bool chdir(const char *path="/");
+
+  FsFile open(const char *path, int oflag=O_RDONLY);
+  bool exists(const char *path);
+  bool mkdir(const char *path, bool pflag=true);
+  bool remove(const char *path);
+  bool rename(const char *oldpath, const char *newpath);
+  bool rmdir(const char *path);
+
+  uint8_t fatType() const { return 64; };
+  uint32_t freeClusterCount() const { return 1000000; };
+  uint32_t sectorsPerCluster() const { return 64; };
+  bool isBusy() const { return false; };
+  SdCard *card() { return &Card; };
+
+  // Path on the host for path on the simulated card.
+  std::string hostPath(const char *path) const;
+
+ protected:
+
+  std::string Root;
+  std::string Cwd;
+  SdCard Card;
+};
+
+
+class SDClass {
+
+ public:
+
+  virtual ~SDClass() {};
+  virtual const char *name() { return "SD"; };
+  bool begin(uint8_t cs) { return sdfs.begin(cs); };
+  File open(const char *path, int oflag=O_RDONLY) { return sdfs.open(path, oflag); };
+  bool exists(const char *path) { return sdfs.exists(path); };
+  bool mkdir(const char *path) { return sdfs.mkdir(path); };
+  bool remove(const char *path) { return sdfs.remove(path); };
+  bool rename(const char *oldpath, const char *newpath)
+    { return sdfs.rename(oldpath, newpath); };
+  bool rmdir(const char *path) { return sdfs.rmdir(path); };
+  bool format(int type=0, char progress=0, Print &pr=Serial) { return false; };
+
+  SdFs sdfs;
+};
+
+extern SDClass SD;
+
+
+#endif
@@ -0,0 +1,6 @@
+#include <SPI.h>
+
+
+SPIClass SPI;
+SPIClass SPI1;
+SPIClass SPI2;
@@ -0,0 +1,24 @@
+/*
+  SPI - Host replacement of the Teensyduino SPI library.
+*/
+
+#ifndef SPI_h
+#define SPI_h
+
+
+#include <Arduino.h>
+
+
+class SPIClass {
+
+ public:
+
+  void begin() {};
+};
+
+extern SPIClass SPI;
+extern SPIClass SPI1;
+extern SPIClass SPI2;
+
+
+#endif
@@ -0,0 +1,56 @@
+#include <TeensyBoard.h>
+
+
+const char *teensyBoard() {
+  return "Teensy 4.1";
+}
+
+
+long teensySpeed() {
+  return F_CPU/1000000;
+}
+
+
+const char *teensySpeedStr() {
+  return "600MHz";
+}
+
+
+void setTeensySpeed(long speed) {
+}
+
+
+void reboot() {
+  exit(1);
+}
+
+
+void halt(Stream &stream) {
+  stream.println("HALT");
+  exit(1);
+}
+
+
+void teensySN(uint8_t *sn) {
+  memset(sn, 0, 4);
+}
+
+
+const char *teensySN(void) {
+  return "00-00-00-00";
+}
+
+
+void teensyMAC(uint8_t *mac) {
+  memset(mac, 0, 6);
+}
+
+
+const char *teensyMAC(void) {
+  return "00:00:00:00:00:00";
+}
+
+
+int analogPin(int8_t pin, char *pins) {
+  return -1;
+}
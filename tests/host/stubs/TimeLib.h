@@ -0,0 +1,21 @@
+/*
+  TimeLib - Host replacement of the Time library using the system clock.
+*/
+
+#ifndef TimeLib_h
+#define TimeLib_h
+
+
+#include <time.h>
+
+
+time_t now();
+int year(time_t t);
+int month(time_t t);
+int day(time_t t);
+int hour(time_t t);
+int minute(time_t t);
+int second(time_t t);
+
+
+#endif
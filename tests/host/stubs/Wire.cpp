@@ -0,0 +1,135 @@
+#include <Wire.h>
+
+
+TwoWire Wire;
+TwoWire Wire1;
+TwoWire Wire2;
+
+
+MockI2CDevice::MockI2CDevice(uint8_t address) :
+  Address(address),
+  Page(0),
+  Pointer(0) {
+  memset(Registers, 0, sizeof(Registers));
+}
+
+
+TwoWire::TwoWire() :
+  NDevices(0),
+  Current(0),
+  TxN(0),
+  RxN(0),
+  RxPos(0) {
+  resetCounts();
+}
+
+
+void TwoWire::attach(MockI2CDevice &device) {
+  if (NDevices < MaxDevices)
+    Devices[NDevices++] = &device;
+}
+
+
+void TwoWire::detachAll() {
+  NDevices = 0;
+  Current = 0;
+  resetCounts();
+}
+
+
+void TwoWire::resetCounts() {
+  Transactions = 0;
+  Bytes = 0;
+  NLog = 0;
+}
+
+
+MockI2CDevice *TwoWire::device(uint8_t address) {
+  for (size_t k=0; k<NDevices; k++) {
+    if (Devices[k]->Address == address)
+      return Devices[k];
+  }
+  return 0;
+}
+
+
+void TwoWire::beginTransmission(uint8_t address) {
+  Current = device(address);
+  TxN = 0;
+}
+
+
+size_t TwoWire::write(uint8_t c) {
+  if (TxN >= sizeof(TxBuffer))
+    return 0;
+  TxBuffer[TxN++] = c;
+  return 1;
+}
+
+
+size_t TwoWire::write(const uint8_t *buffer, size_t n) {
+  size_t m = 0;
+  for (size_t k=0; k<n; k++)
+    m += write(buffer[k]);
+  return m;
+}
+
+
+uint8_t TwoWire::endTransmission(bool stop) {
+  Transactions++;
+  Bytes += 1 + TxN;
+  if (Current == 0)
+    return 2;      // address not acknowledged
+  if (TxN == 0)
+    return 0;
+  Current->Pointer = TxBuffer[0];
+  if (TxN > 1 && NLog < MaxLog) {
+    Log[NLog].Address = Current->Address;
+    Log[NLog].Page = Current->Page;
+    Log[NLog].Register = TxBuffer[0];
+    Log[NLog].N = TxN - 1;
+    NLog++;
+  }
+  for (size_t k=1; k<TxN; k++) {
+    if (Current->Pointer == 0)
+      Current->Page = TxBuffer[k];
+    Current->Registers[Current->Page][Current->Pointer++] = TxBuffer[k];
+  }
+  return 0;
+}
+
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t n, uint8_t stop) {
+  Transactions++;
+  Current = device(address);
+  RxN = 0;
+  RxPos = 0;
+  if (Current == 0) {
+    Bytes++;
+    return 0;
+  }
+  Bytes += 1 + n;
+  for (size_t k=0; k<n; k++) {
+    if (Current->Pointer == 0)
+      RxBuffer[RxN++] = Current->Page;
+    else
+      RxBuffer[RxN++] = Current->Registers[Current->Page][Current->Pointer];
+    Current->Pointer++;
+  }
+  return RxN;
+}
+
+
+int TwoWire::available() {
+  return RxN - RxPos;
+}
+
+
+int TwoWire::read() {
+  return RxPos < RxN ? RxBuffer[RxPos++] : -1;
+}
+
+
+int TwoWire::peek() {
+  return RxPos < RxN ? RxBuffer[RxPos] : -1;
+}
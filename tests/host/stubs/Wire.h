@@ -0,0 +1,97 @@
+/*
+  Wire - Host replacement of the Teensyduino I2C library.
+  TwoWire talks to simulated devices and counts the transactions.
+*/
+
+#ifndef Wire_h
+#define Wire_h
+
+
+#include <Arduino.h>
+
+
+// Simulated I2C device with 8-bit registers on 256 pages.
+// Register 0x00 of each page selects the page. The register pointer
+// is set by the first byte of a write transaction and auto-increments
+// on each written or read byte.
+class MockI2CDevice {
+
+ public:
+
+  MockI2CDevice(uint8_t address);
+
+  // Value of register reg on page.
+  uint8_t &reg(uint8_t page, uint8_t reg) { return Registers[page][reg]; };
+
+  uint8_t Address;
+  uint8_t Page;
+  uint8_t Pointer;
+  uint8_t Registers[256][256];
+};
+
+
+class TwoWire : public Stream {
+
+ public:
+
+  TwoWire();
+
+  void begin() {};
+  void setClock(uint32_t) {};
+  void beginTransmission(uint8_t address);
+  uint8_t endTransmission(bool stop=true);
+  uint8_t requestFrom(uint8_t address, uint8_t n, uint8_t stop=1);
+  virtual size_t write(uint8_t c);
+  virtual size_t write(const uint8_t *buffer, size_t n);
+  size_t write(int c) { return write((uint8_t)c); };
+  using Print::write;
+  virtual int available();
+  virtual int read();
+  virtual int peek();
+
+  // Connect a simulated device to this bus.
+  void attach(MockI2CDevice &device);
+
+  // Disconnect all devices and reset the counters.
+  void detachAll();
+
+  // Reset the counters and the log.
+  void resetCounts();
+
+  // A single write transaction of a burst of registers.
+  struct Write {
+    uint8_t Address;
+    uint8_t Page;
+    uint8_t Register;
+    uint8_t N;
+  };
+
+  static const size_t MaxLog = 1024;
+
+  size_t Transactions;   // number of write and read transactions.
+  size_t Bytes;          // bytes on the bus including address bytes.
+  size_t NLog;           // number of logged write transactions.
+  Write Log[MaxLog];     // write transactions with data bytes.
+
+ protected:
+
+  MockI2CDevice *device(uint8_t address);
+
+  static const size_t MaxDevices = 8;
+  MockI2CDevice *Devices[MaxDevices];
+  size_t NDevices;
+
+  MockI2CDevice *Current;
+  uint8_t TxBuffer[256];
+  size_t TxN;
+  uint8_t RxBuffer[256];
+  size_t RxN;
+  size_t RxPos;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+extern TwoWire Wire2;
+
+
+#endif
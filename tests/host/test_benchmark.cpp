@@ -0,0 +1,78 @@
+// Host test of SDCard::benchmarkRecorder() on a temporary directory.
+// Replays a short recording and checks the reported statistics.
+
+#include <Arduino.h>
+#include <SD.h>
+#include <SDCard.h>
+#include <dirent.h>
+#include <unistd.h>
+#include "check.h"
+
+
+// Collects everything printed to it.
+class StringStream : public Stream {
+
+ public:
+
+  virtual int available() { return 0; };
+  virtual int read() { return -1; };
+  virtual int peek() { return -1; };
+  virtual size_t write(uint8_t c) { Text += char(c); return 1; };
+  using Print::write;
+
+  std::string Text;
+};
+
+
+// Value in milliseconds following label in text, negative if missing.
+static double value(const std::string &text, const char *label) {
+  size_t i = text.find(label);
+  if (i == std::string::npos)
+    return -1.0;
+  i = text.find(':', i);
+  return atof(text.c_str() + i + 1);
+}
+
+
+static size_t countFiles(const char *path) {
+  size_t n = 0;
+  DIR *dir = opendir(path);
+  while (struct dirent *entry = readdir(dir)) {
+    if (entry->d_name[0] != '.')
+      n++;
+  }
+  closedir(dir);
+  return n;
+}
+
+
+int main() {
+  char root[] = "/tmp/teerec-sdXXXXXX";
+  CHECK(mkdtemp(root) != 0);
+  HostSDRoot = root;
+  SDCard sdcard;
+  CHECK(sdcard.begin(BUILTIN_SDCARD));
+
+  // 4 channels at 48kHz, written every 20ms into files of 1s:
+  StringStream out;
+  float buffer = sdcard.benchmarkRecorder(48000, 4, 0.02, 1.0, 3.0, out);
+  printf("%s", out.Text.c_str());
+  CHECK(buffer >= 0.02);
+  CHECK(out.Text.find("Done") != std::string::npos);
+  CHECK(value(out.Text, "Files written") >= 3);
+  double p50 = value(out.Text, "50% percentile");
+  double p90 = value(out.Text, "90% percentile");
+  double p99 = value(out.Text, "99% percentile");
+  double pmax = value(out.Text, "Maximum latency");
+  CHECK(p50 >= 0.0);
+  CHECK(p50 <= p90 && p90 <= p99);
+  // percentiles are bin centers, at most 6.25% off:
+  CHECK(p99 <= 1.07*pmax);
+  // the bench files are removed again:
+  CHECK(countFiles(root) == 0);
+
+  sdcard.end();
+  rmdir(root);
+
+  return report("test_benchmark");
+}
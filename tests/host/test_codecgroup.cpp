@@ -0,0 +1,114 @@
+// Host test of CodecGroup with two PCM186x chips on a mock TwoWire.
+// Interleaved group flushes need to leave the chips with the same
+// register contents as configuring them one after the other.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <string.h>
+#include <CodecGroup.h>
+#include "check.h"
+
+
+static MockI2CDevice Dev1(PCM186x_I2C_ADDR1);
+static MockI2CDevice Dev2(PCM186x_I2C_ADDR2);
+
+
+// Fill the simulated chips with arbitrary but known contents.
+static void resetDevices() {
+  for (int p=0; p<256; p++) {
+    for (int r=1; r<256; r++) {
+      Dev1.reg(p, r) = r;
+      Dev2.reg(p, r) = r;
+    }
+  }
+  Dev1.Page = Dev2.Page = 0;
+  Wire.detachAll();
+  Wire.attach(Dev1);
+  Wire.attach(Dev2);
+}
+
+
+static void setupPCM(ControlPCM186x &pcm, bool offs) {
+  pcm.setMicBias(false, true);
+  pcm.setupChannels(ControlPCM186x::CH1L, ControlPCM186x::CH1R,
+		    ControlPCM186x::CH2L, ControlPCM186x::CH2R);
+  pcm.setupTDM(offs);
+  pcm.setSmoothGainChange(false);
+  pcm.setGainDecibel(ControlPCM186x::ADCLR, 20);
+  pcm.setFilters(ControlPCM186x::FIR, false);
+}
+
+
+int main() {
+  // configure chips one after the other:
+  resetDevices();
+  ControlPCM186x seq1(Wire, PCM186x_I2C_ADDR1);
+  ControlPCM186x seq2(Wire, PCM186x_I2C_ADDR2);
+  CHECK(seq1.begin());
+  CHECK(seq2.begin());
+  Wire.resetCounts();
+  setupPCM(seq1, false);
+  setupPCM(seq2, true);
+  size_t nseq = Wire.Transactions;
+  static uint8_t regs1[256][256];
+  static uint8_t regs2[256][256];
+  memcpy(regs1, Dev1.Registers, sizeof(regs1));
+  memcpy(regs2, Dev2.Registers, sizeof(regs2));
+
+  // configure chips as a group:
+  resetDevices();
+  ControlPCM186x pcm1(Wire, PCM186x_I2C_ADDR1);
+  ControlPCM186x pcm2(Wire, PCM186x_I2C_ADDR2);
+  CodecGroup codecs;
+  CHECK(codecs.add(pcm1));
+  CHECK(codecs.add(pcm2));
+  CHECK(pcm1.begin());
+  CHECK(pcm2.begin());
+  Wire.resetCounts();
+  codecs.beginBatch();
+  setupPCM(pcm1, false);
+  setupPCM(pcm2, true);
+  // only registers on pages other than page 0 are not cached:
+  for (size_t k=0; k<Wire.NLog; k++)
+    CHECK(Wire.Log[k].Page != 0 || Wire.Log[k].Register == 0);
+  CHECK(codecs.flush());
+  size_t ngroup = Wire.Transactions;
+  printf("  setup sequential: %2zu transactions\n", nseq);
+  printf("  setup as group:   %2zu transactions\n", ngroup);
+  CHECK(ngroup <= nseq);
+  CHECK(memcmp(regs1, Dev1.Registers, sizeof(regs1)) == 0);
+  CHECK(memcmp(regs2, Dev2.Registers, sizeof(regs2)) == 0);
+  CHECK(codecs.verify());
+
+  // a gain change of both chips is one burst each, back to back:
+  Wire.resetCounts();
+  codecs.beginBatch();
+  pcm1.setGainDecibel(ControlPCM186x::ADCLR, 30);
+  pcm2.setGainDecibel(ControlPCM186x::ADCLR, 30);
+  CHECK(codecs.flush());
+  printf("  gain change:      %2zu transactions\n", Wire.Transactions);
+  CHECK(Wire.NLog == 2);
+  CHECK(Wire.Log[0].Address == PCM186x_I2C_ADDR1);
+  CHECK(Wire.Log[1].Address == PCM186x_I2C_ADDR2);
+  CHECK(Wire.Log[0].Register == Wire.Log[1].Register);
+  CHECK(Wire.Log[0].N == Wire.Log[1].N);
+  CHECK(pcm1.gainDecibel(ControlPCM186x::ADC1L) == 30);
+  CHECK(pcm2.gainDecibel(ControlPCM186x::ADC1L) == 30);
+
+  // verify() catches a register corrupted on the second chip:
+  uint8_t page = Wire.Log[1].Page;
+  uint8_t reg = Wire.Log[1].Register;
+  CHECK(page == 0);
+  Dev2.reg(page, reg) ^= 0x01;
+  fflush(stdout);
+  FILE *out = stdout;
+  stdout = fopen("/dev/null", "w");
+  bool verified = codecs.verify();
+  fclose(stdout);
+  stdout = out;
+  CHECK(!verified);
+  CHECK(pcm2.registers().read(reg) == Dev2.reg(page, reg));
+  CHECK(pcm1.registers().read(reg) == Dev1.reg(page, reg));
+
+  return report("test_codecgroup");
+}
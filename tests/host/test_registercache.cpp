@@ -0,0 +1,184 @@
+// Host test of RegisterCache and the cached codec drivers.
+// Counts the I2C transactions on a mock TwoWire and checks that the
+// simulated devices end up with the expected register contents.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <RegisterCache.h>
+#include <ControlPCM186x.h>
+#include <ControlTLV320ADC.h>
+#include "check.h"
+
+
+// Registers of page 0 the cache knows about need to match the device.
+static void checkConsistent(RegisterCache &regs, MockI2CDevice &dev) {
+  size_t n = 0;
+  for (uint8_t r=1; r<RegisterCache::NRegisters; r++) {
+    if (regs.read(r) != dev.reg(0, r))
+      n++;
+  }
+  CHECK(n == 0);
+}
+
+
+static void testCache() {
+  MockI2CDevice dev(0x4A);
+  for (int r=0; r<128; r++)
+    dev.reg(0, r) = r;
+  Wire.detachAll();
+  Wire.attach(dev);
+  RegisterCache regs(Wire, 0x4A);
+  regs.setVolatile(0x70, 0x7F);
+
+  // burst read of the whole page:
+  CHECK(regs.fetch(0x01, 0x7F));
+  CHECK(Wire.Transactions <= 2 + 2*((127 + RegisterCache::MaxBurst - 1)/RegisterCache::MaxBurst));
+  Wire.resetCounts();
+
+  // cached reads do not touch the bus:
+  CHECK(regs.read(0x05) == 0x05);
+  CHECK(regs.read(0x20) == 0x20);
+  CHECK(Wire.Transactions == 0);
+
+  // volatile registers always do:
+  dev.reg(0, 0x72) = 0xAB;
+  CHECK(regs.read(0x72) == 0xAB);
+  CHECK(Wire.Transactions == 2);
+  Wire.resetCounts();
+
+  // writing an unchanged value is skipped:
+  CHECK(regs.write(0x05, 0x05));
+  CHECK(Wire.Transactions == 0);
+  CHECK(regs.write(0x05, 0x15));
+  CHECK(Wire.Transactions == 1);
+  CHECK(dev.reg(0, 0x05) == 0x15);
+  Wire.resetCounts();
+
+  // the page register is only written when the page changes:
+  CHECK(regs.write(0x0102, 0x33));
+  CHECK(regs.write(0x0103, 0x34));
+  CHECK(Wire.Transactions == 3);
+  CHECK(dev.reg(1, 0x02) == 0x33 && dev.reg(1, 0x03) == 0x34);
+  CHECK(regs.read(0x0102) == 0x33);
+  CHECK(regs.write(0x06, 0x16));
+  CHECK(Wire.Transactions == 3 + 2 + 2);
+  Wire.resetCounts();
+
+  // batched writes go out in a single burst, bridging small gaps:
+  regs.beginBatch();
+  CHECK(regs.write(0x10, 0xA0));
+  CHECK(regs.write(0x11, 0xA1));
+  CHECK(regs.write(0x13, 0xA3));
+  CHECK(regs.write(0x40, 0xB0));
+  CHECK(Wire.Transactions == 0);
+  CHECK(regs.flush());
+  CHECK(Wire.Transactions == 2);
+  CHECK(Wire.NLog == 2);
+  CHECK(Wire.Log[0].Register == 0x10 && Wire.Log[0].N == 4);
+  CHECK(Wire.Log[1].Register == 0x40 && Wire.Log[1].N == 1);
+  CHECK(dev.reg(0, 0x13) == 0xA3 && dev.reg(0, 0x12) == 0x12);
+  Wire.resetCounts();
+
+  // nested batches only write on the outermost flush():
+  regs.beginBatch();
+  regs.beginBatch();
+  CHECK(regs.write(0x20, 0xC0));
+  CHECK(regs.flush());
+  CHECK(Wire.Transactions == 0);
+  CHECK(regs.flush());
+  CHECK(Wire.Transactions == 1);
+  Wire.resetCounts();
+
+  // verify() finds registers changed behind the back of the cache:
+  CHECK(regs.verify());
+  CHECK(regs.write(0x21, 0xC1));
+  dev.reg(0, 0x21) = 0x00;
+  CHECK(!regs.verify());
+  CHECK(regs.read(0x21) == 0x00);
+
+  checkConsistent(regs, dev);
+}
+
+
+// Number n of I2C transactions needed by stmt.
+#define TRANSACTIONS(n, ...) { Wire.resetCounts(); __VA_ARGS__; n = Wire.Transactions; }
+
+
+static void testPCM186x() {
+  MockI2CDevice dev(PCM186x_I2C_ADDR1);
+  Wire.detachAll();
+  Wire.attach(dev);
+  ControlPCM186x pcm(Wire, PCM186x_I2C_ADDR1);
+  uint64_t delay0 = HostDelay;
+  CHECK(pcm.begin());
+  size_t n = 0;
+  TRANSACTIONS(n, pcm.setupChannels(ControlPCM186x::CH2L,
+				    ControlPCM186x::CH2R,
+				    ControlPCM186x::CH3L,
+				    ControlPCM186x::CH3R));
+  printf("  PCM186x setupChannels(4):  %2zu transactions\n", n);
+  CHECK(n == 1);
+  TRANSACTIONS(n, pcm.setupTDM());
+  printf("  PCM186x setupTDM():        %2zu transactions\n", n);
+  CHECK(n == 1);
+  TRANSACTIONS(n, pcm.setGainDecibel(ControlPCM186x::ADCLR, 20));
+  printf("  PCM186x setGainDecibel():  %2zu transactions\n", n);
+  CHECK(n <= 2);
+  TRANSACTIONS(n, pcm.setGainDecibel(ControlPCM186x::ADCLR, 20));
+  printf("  PCM186x same gain again:   %2zu transactions\n", n);
+  CHECK(n == 0);
+  TRANSACTIONS(n, for (int k=0; k<4; k++) pcm.gainDecibel(ControlPCM186x::ADC1L));
+  CHECK(n == 0);
+  CHECK(pcm.gainDecibel(ControlPCM186x::ADC1L) == 20);
+  fflush(stdout);
+  FILE *out = stdout;
+  stdout = fopen("/dev/null", "w");
+  TRANSACTIONS(n, pcm.printRegisters());
+  fclose(stdout);
+  stdout = out;
+  printf("  PCM186x printRegisters():  %2zu transactions\n", n);
+  CHECK(n <= 24);
+  printf("  PCM186x write delays:      %2lu ms\n",
+	 (unsigned long)(HostDelay - delay0));
+  checkConsistent(pcm.registers(), dev);
+}
+
+
+struct TestTLV320ADC : public ControlTLV320ADC {
+  using ControlTLV320ADC::ControlTLV320ADC;
+  bool activate() { return setActive(); };
+};
+
+
+static void testTLV320ADC() {
+  MockI2CDevice dev(TLV320_I2C_ADDR1);
+  Wire.detachAll();
+  Wire.attach(dev);
+  TestTLV320ADC tlv(Wire, TLV320_I2C_ADDR1);
+  CHECK(tlv.begin());
+  CHECK(tlv.setupChannels(4));
+  size_t n = 0;
+  // setupTDM() writes two registers and activates the channels:
+  TRANSACTIONS(n, CHECK(tlv.setupTDM()));
+  printf("  TLV320ADC setupTDM():      %2zu transactions\n", n);
+  CHECK(n <= 3);
+  CHECK(dev.reg(0, 0x73) == 0xF0 && dev.reg(0, 0x74) == 0xF0);
+  TRANSACTIONS(n, tlv.activate());
+  CHECK(n == 0);
+  TRANSACTIONS(n, for (int c=0; c<4; c++) tlv.setGainDecibel(c, 20));
+  printf("  TLV320ADC setGainDecibel(): %zu transactions\n", n);
+  CHECK(n <= 4);
+  TRANSACTIONS(n, for (int c=0; c<4; c++) tlv.setGainDecibel(c, 20));
+  CHECK(n == 0);
+}
+
+
+int main() {
+  printf("RegisterCache:\n");
+  testCache();
+  printf("ControlPCM186x:\n");
+  testPCM186x();
+  printf("ControlTLV320ADC:\n");
+  testTLV320ADC();
+  return report("test_registercache");
+}
@@ -0,0 +1,128 @@
+// Host test of SDCard::repairWave() and SDCard::repairWaveFiles().
+// Copies of the recordings in tests/teensy3.5 with the sizes in their
+// wave headers zeroed, as left by a recorder losing power, need to be
+// repaired to exactly their original headers.
+
+#include <Arduino.h>
+#include <SD.h>
+#include <SDCard.h>
+#include <WaveHeader.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "check.h"
+
+
+static const char *WaveFiles[] = {"teensysine-20mV.wav",
+				  "teensysine-800mV.wav",
+				  "teensysine-1500mV.wav"};
+static const size_t NWaveFiles = sizeof(WaveFiles)/sizeof(WaveFiles[0]);
+
+
+struct TestSDCard : public SDCard {
+  using SDCard::repairWave;
+};
+
+
+static std::string readFile(const std::string &path) {
+  std::string data;
+  FILE *f = fopen(path.c_str(), "rb");
+  if (f == 0)
+    return data;
+  char buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    data.append(buffer, n);
+  fclose(f);
+  return data;
+}
+
+
+static void writeFile(const std::string &path, const std::string &data) {
+  FILE *f = fopen(path.c_str(), "wb");
+  fwrite(data.data(), 1, data.size(), f);
+  fclose(f);
+}
+
+
+// Zero the RIFF and data chunk sizes.
+static std::string corrupt(const std::string &data, size_t nheader) {
+  std::string broken = data;
+  memset(&broken[4], 0, 4);
+  memset(&broken[nheader - 4], 0, 4);
+  return broken;
+}
+
+
+int main() {
+  char root[] = "/tmp/teerec-sdXXXXXX";
+  CHECK(mkdtemp(root) != 0);
+  HostSDRoot = root;
+
+  std::string originals[NWaveFiles];
+  size_t nheaders[NWaveFiles];
+  for (size_t k=0; k<NWaveFiles; k++) {
+    originals[k] = readFile(std::string("../teensy3.5/") + WaveFiles[k]);
+    CHECK(originals[k].size() > WaveHeader::MaxBuffer);
+    WaveHeader wave;
+    CHECK(wave.parse(originals[k].data(), WaveHeader::MaxBuffer));
+    nheaders[k] = wave.NBuffer;
+    printf("  %-22s %d channels, %uHz, %d bits, %lld samples\n",
+	   WaveFiles[k], wave.nchannels(), wave.rate(), wave.bitsPerSample(),
+	   (long long)wave.samples());
+    CHECK(wave.nchannels() > 0 && wave.bitsPerSample() == 16);
+    CHECK(wave.NBuffer + wave.samples()*wave.bitsPerSample()/8 == originals[k].size());
+    // a consistent header is left as it is:
+    CHECK(!wave.setFileSize(originals[k].size()));
+    CHECK(memcmp(wave.Buffer, originals[k].data(), wave.NBuffer) == 0);
+    writeFile(std::string(root) + "/" + WaveFiles[k],
+	      corrupt(originals[k], nheaders[k]));
+  }
+  writeFile(std::string(root) + "/notes.txt", "not a wave file");
+  writeFile(std::string(root) + "/empty.wav", "");
+
+  TestSDCard sdcard;
+  CHECK(sdcard.begin(BUILTIN_SDCARD));
+
+  // repair all broken files of a directory:
+  CHECK(sdcard.repairWaveFiles("/") == NWaveFiles);
+  for (size_t k=0; k<NWaveFiles; k++) {
+    std::string repaired = readFile(std::string(root) + "/" + WaveFiles[k]);
+    CHECK(repaired == originals[k]);
+  }
+  CHECK(readFile(std::string(root) + "/notes.txt") == "not a wave file");
+
+  // a recording cut off within the data:
+  size_t nframes = 1000;
+  WaveHeader wave;
+  wave.parse(originals[0].data(), WaveHeader::MaxBuffer);
+  size_t nbytes = nheaders[0] + nframes*wave.nchannels()*wave.bitsPerSample()/8;
+  writeFile(std::string(root) + "/cut.wav",
+	    corrupt(originals[0].substr(0, nbytes), nheaders[0]));
+  FsFile file = sdcard.sdfs.open("cut.wav", O_RDWR);
+  CHECK(file);
+  CHECK(sdcard.repairWave(file));
+  file.close();
+  std::string repaired = readFile(std::string(root) + "/cut.wav");
+  CHECK(repaired.size() == nbytes);
+  WaveHeader cut;
+  CHECK(cut.parse(repaired.data(), WaveHeader::MaxBuffer));
+  CHECK(cut.samples() == int64_t(nframes*wave.nchannels()));
+
+  // headers that can not be parsed are not touched:
+  file = sdcard.sdfs.open("notes.txt", O_RDWR);
+  CHECK(!sdcard.repairWave(file));
+  file.close();
+  file = sdcard.sdfs.open("empty.wav", O_RDWR);
+  CHECK(!sdcard.repairWave(file));
+  file.close();
+
+  sdcard.end();
+  for (size_t k=0; k<NWaveFiles; k++)
+    unlink((std::string(root) + "/" + WaveFiles[k]).c_str());
+  unlink((std::string(root) + "/notes.txt").c_str());
+  unlink((std::string(root) + "/empty.wav").c_str());
+  unlink((std::string(root) + "/cut.wav").c_str());
+  rmdir(root);
+
+  return report("test_repairwave");
+}
@@ -0,0 +1,212 @@
+# https://github.com/pyserial/pyserial
+try:
+    import serial
+    from serial.tools.list_ports import comports
+except ImportError:
+    print('ERROR: failed to import serial module !')
+    print('You need to install the pyserial package using')
+    print('> pip install pyserial')
+    exit()
+
+import os
+import math
+import wave
+import zlib
+import struct
+import argparse
+import threading
+from time import sleep, time
+
+
+magic = b'TRSB'
+header_format = '<4sBBHIIQI'
+header_size = struct.calcsize(header_format)   # 28 bytes
+
+
+def discover_teensy():
+    for port in sorted(comports(False)):
+        if port.manufacturer == 'Teensyduino':
+            return port.device
+    return None
+
+
+class BlockReader:
+    """Find, check, and parse data blocks in a byte stream."""
+
+    def __init__(self, read):
+        self.read = read
+        self.buffer = b''
+        self.crc_errors = 0
+        self.skipped_bytes = 0
+
+    def _fill(self, n):
+        while len(self.buffer) < n:
+            data = self.read(max(n - len(self.buffer), 1))
+            if not data:
+                return False
+            self.buffer += data
+        return True
+
+    def next_block(self):
+        """Return next valid block.
+
+        Returns
+        -------
+        index: int
+            Index of the first frame of the block.
+        nchannels: int
+            Number of channels.
+        rate: int
+            Sampling rate in Hertz.
+        dropped: int
+            Total number of frames dropped so far.
+        data: bytes
+            Multiplexed 16-bit little endian samples.
+        """
+        while True:
+            if not self._fill(header_size):
+                return None
+            start = self.buffer.find(magic)
+            if start < 0:
+                self.skipped_bytes += len(self.buffer) - len(magic) + 1
+                self.buffer = self.buffer[-len(magic) + 1:]
+                continue
+            if start > 0:
+                self.skipped_bytes += start
+                self.buffer = self.buffer[start:]
+                continue
+            _, version, nchannels, nframes, rate, dropped, index, crc = \
+                struct.unpack(header_format, self.buffer[:header_size])
+            nbytes = header_size + 2*nchannels*nframes
+            if version != 1 or nchannels == 0 or \
+               not self._fill(nbytes):
+                self.skipped_bytes += 1
+                self.buffer = self.buffer[1:]
+                continue
+            data = self.buffer[header_size:nbytes]
+            check = zlib.crc32(self.buffer[:header_size - 4])
+            check = zlib.crc32(data, check)
+            if check != crc:
+                # corrupted block, resynchronize on next magic:
+                self.crc_errors += 1
+                self.buffer = self.buffer[1:]
+                continue
+            self.buffer = self.buffer[nbytes:]
+            return index, nchannels, rate, dropped, data
+
+
+def simulate(fd, nchannels=4, rate=44100, nframes=256):
+    """Write blocks of sine waves to file descriptor in real time."""
+    index = 0
+    dropped = 0
+    blocks = 0
+    t0 = time()
+    while True:
+        samples = []
+        for k in range(nframes):
+            for c in range(nchannels):
+                x = 0.5*math.sin(2*math.pi*500*(c + 1)*(index + k)/rate)
+                samples.append(int(32767*x))
+        data = struct.pack(f'<{len(samples)}h', *samples)
+        header = struct.pack(header_format[:-1], magic, 1, nchannels,
+                             nframes, rate, dropped, index)
+        crc = zlib.crc32(data, zlib.crc32(header))
+        block = header + struct.pack('<I', crc) + data
+        blocks += 1
+        if blocks % 100 == 0:
+            # corrupt a block:
+            block = block[:40] + b'\x00\x00' + block[42:]
+        if blocks % 150 == 0:
+            # drop a block:
+            dropped += nframes
+        else:
+            os.write(fd, block)
+        index += nframes
+        delay = t0 + index/rate - time()
+        if delay > 0:
+            sleep(delay)
+
+
+def stream(device, file_path=None):
+    """Read blocks from device, report statistics, and save data.
+
+    Frames dropped by the device or lost in corrupted blocks are
+    written as zeros to the wave file, so that times in the file match
+    the frame indices of the device. Gaps are detected from the frame
+    indices in the block headers.
+    """
+    ser = serial.Serial(device, timeout=1)
+    ser.reset_input_buffer()
+    reader = BlockReader(ser.read)
+    wf = None
+    next_index = None
+    frames = 0
+    gaps = 0
+    report_time = time()
+    report_frames = 0
+    try:
+        while True:
+            block = reader.next_block()
+            if block is None:
+                continue
+            index, nchannels, rate, dropped, data = block
+            nframes = len(data)//2//nchannels
+            npad = 0
+            if next_index is not None and index != next_index:
+                gaps += 1
+                if index > next_index:
+                    npad = index - next_index
+            frames += nframes
+            if file_path and wf is None:
+                wf = wave.open(file_path, 'wb')
+                wf.setnchannels(nchannels)
+                wf.setsampwidth(2)
+                wf.setframerate(rate)
+            if wf is not None:
+                zeros = bytes(2*nchannels*min(npad, 65536))
+                while npad > 0:
+                    n = min(npad, 65536)
+                    wf.writeframesraw(zeros[:2*nchannels*n])
+                    npad -= n
+                wf.writeframesraw(data)
+            next_index = index + nframes
+            if time() - report_time >= 1.0:
+                dt = time() - report_time
+                print(f'{nchannels} channels @ {rate}Hz: '
+                      f'{(frames - report_frames)/dt:8.0f} frames/s, '
+                      f'{dropped:6d} frames dropped, {gaps:3d} gaps, '
+                      f'{reader.crc_errors:3d} CRC errors')
+                report_time = time()
+                report_frames = frames
+    except (OSError, serial.serialutil.SerialException):
+        print()
+        print('disconnected')
+    except KeyboardInterrupt:
+        print()
+    finally:
+        if wf is not None:
+            wf.close()
+        ser.close()
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Read binary data blocks streamed by SerialStreamer.')
+    parser.add_argument('-o', dest='file', default=None, type=str,
+                        metavar='FILE', help='save data to wave file')
+    parser.add_argument('-s', dest='simulate', action='store_true',
+                        help='read from a simulated device on a pseudo terminal')
+    parser.add_argument('device', nargs='?', default=None, type=str,
+                        help='serial device')
+    args = parser.parse_args()
+    device = args.device
+    if args.simulate:
+        master, slave = os.openpty()
+        device = os.ttyname(slave)
+        threading.Thread(target=simulate, args=(master,), daemon=True).start()
+    if device is None:
+        print('Waiting for Teensy device ...')
+        while device is None:
+            device = discover_teensy()
+            sleep(0.1)
+    print(f'reading from {device}')
+    stream(device, args.file)